@@ -0,0 +1,170 @@
+// Microbenchmark for the batch integration kernels. Times one body step
+// (kick, drift, then circle bounds and wall clamping, every other body
+// asleep) and one particle step (kick, drift and wall clamping) per kernel
+// on large random batches, and checks that every kernel leaves exactly the
+// same state as the scalar one.
+//
+//   integrate_bench [--count N] [--rounds N]
+//
+// Prints one JSON document; ns_per_item is the time per body or particle.
+#include "IntegrateKernels.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct BodyState {
+    std::vector<std::uint8_t> mask;
+    std::vector<float> posX, posY, angle, velX, velY, angularVel, accX, accY, torque, invInertia;
+    std::vector<float> radius, boxes;
+
+    IntegrateKernels::Bodies arrays() {
+        return {mask.data(), posX.data(), posY.data(), angle.data(), velX.data(), velY.data(),
+                angularVel.data(), accX.data(), accY.data(), torque.data(), invInertia.data()};
+    }
+    IntegrateKernels::Circles circles() { return {mask.data(), posX.data(), posY.data(), radius.data(), boxes.data()}; }
+    std::vector<std::vector<float>*> fields() {
+        return {&posX, &posY, &angle, &velX, &velY, &angularVel, &torque, &boxes};
+    }
+};
+
+struct ParticleState {
+    std::vector<float> posX, posY, velX, velY, accX, accY, radius;
+
+    IntegrateKernels::Particles arrays() {
+        return {posX.data(), posY.data(), velX.data(), velY.data(), accX.data(), accY.data(), radius.data()};
+    }
+    std::vector<std::vector<float>*> fields() { return {&posX, &posY, &velX, &velY}; }
+};
+
+const float DT = 1.0f / 120.0f;
+const sf::Vector2f GRAVITY(0.0f, 1000.0f);
+const IntegrateKernels::Walls WALLS{{0.0f, 0.0f, 1600.0f, 1200.0f}, 0.2f, 0.95f};
+
+BodyState makeBodies(size_t count) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(0.0f, 1600.0f), vel(-300.0f, 300.0f), unit(-1.0f, 1.0f);
+    BodyState b;
+    for (size_t i = 0; i < count; i++) {
+        b.mask.push_back(i % 2 ? 1 : 0);
+        b.posX.push_back(pos(rng));
+        b.posY.push_back(pos(rng));
+        b.angle.push_back(unit(rng) * 3.0f);
+        b.velX.push_back(vel(rng));
+        b.velY.push_back(vel(rng));
+        b.angularVel.push_back(unit(rng));
+        b.accX.push_back(0.0f);
+        b.accY.push_back(1000.0f);
+        b.torque.push_back(unit(rng) * 100.0f);
+        b.invInertia.push_back(0.001f);
+        b.radius.push_back(10.0f);
+        b.boxes.insert(b.boxes.end(), 4, 0.0f);
+    }
+    return b;
+}
+
+ParticleState makeParticles(size_t count) {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> pos(-20.0f, 1620.0f), vel(-3000.0f, 3000.0f), acc(-500.0f, 500.0f);
+    ParticleState p;
+    for (size_t i = 0; i < count; i++) {
+        p.posX.push_back(pos(rng));
+        p.posY.push_back(pos(rng));
+        p.velX.push_back(vel(rng));
+        p.velY.push_back(vel(rng));
+        p.accX.push_back(acc(rng));
+        p.accY.push_back(acc(rng));
+        p.radius.push_back(3.0f);
+    }
+    return p;
+}
+
+void stepBodies(IntegrateKernels::Kernel kernel, BodyState& b) {
+    IntegrateKernels::Bodies arrays = b.arrays();
+    IntegrateKernels::accelerate(kernel, arrays, 0, b.mask.size(), DT, DT);
+    IntegrateKernels::drift(kernel, arrays, 0, b.mask.size(), DT);
+    IntegrateKernels::boundCircles(kernel, b.circles(), 0, b.mask.size(), WALLS.bounds);
+}
+
+void stepParticles(IntegrateKernels::Kernel kernel, ParticleState& p) {
+    IntegrateKernels::integrateParticles(kernel, p.arrays(), 0, p.posX.size(), GRAVITY, DT, WALLS);
+}
+
+template <typename State, typename Step>
+double nsPerItem(State state, size_t count, int rounds, Step step) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        step(state);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / (static_cast<double>(rounds) * count);
+}
+
+// Bitwise, so -0 against +0 or differing NaNs count too.
+template <typename State>
+size_t countMismatches(State a, State b) {
+    size_t mismatches = 0;
+    std::vector<std::vector<float>*> fa = a.fields(), fb = b.fields();
+    for (size_t f = 0; f < fa.size(); f++) {
+        for (size_t i = 0; i < fa[f]->size(); i++) {
+            if (std::memcmp(&(*fa[f])[i], &(*fb[f])[i], sizeof(float)) != 0) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = 100000;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--count") && i + 1 < argc) count = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) rounds = std::atoi(argv[++i]);
+        else {
+            std::cerr << "usage: integrate_bench [--count N] [--rounds N]\n";
+            return 1;
+        }
+    }
+
+    std::vector<IntegrateKernels::Kernel> kernels;
+    for (IntegrateKernels::Kernel k : {IntegrateKernels::Kernel::Scalar, IntegrateKernels::Kernel::Sse,
+                                       IntegrateKernels::Kernel::Avx2}) {
+        if (IntegrateKernels::available(k)) kernels.push_back(k);
+    }
+
+    BodyState bodies = makeBodies(count);
+    ParticleState particles = makeParticles(count);
+    // Reference states after a few scalar steps, for the mismatch counts.
+    BodyState refBodies = bodies;
+    ParticleState refParticles = particles;
+    for (int r = 0; r < 10; r++) {
+        stepBodies(IntegrateKernels::Kernel::Scalar, refBodies);
+        stepParticles(IntegrateKernels::Kernel::Scalar, refParticles);
+    }
+
+    std::cout << "{\n  \"count\": " << count << ", \"rounds\": " << rounds
+              << ", \"best\": \"" << IntegrateKernels::name(IntegrateKernels::best()) << "\",\n  \"kernels\": [\n";
+    for (size_t k = 0; k < kernels.size(); k++) {
+        IntegrateKernels::Kernel kernel = kernels[k];
+        double bodyNs = nsPerItem(bodies, count, rounds, [kernel](BodyState& b) { stepBodies(kernel, b); });
+        double particleNs = nsPerItem(particles, count, rounds, [kernel](ParticleState& p) { stepParticles(kernel, p); });
+
+        BodyState b = bodies;
+        ParticleState p = particles;
+        for (int r = 0; r < 10; r++) {
+            stepBodies(kernel, b);
+            stepParticles(kernel, p);
+        }
+        std::cout << "    {\"kernel\": \"" << IntegrateKernels::name(kernel)
+                  << "\", \"body_ns_per_item\": " << bodyNs << ", \"particle_ns_per_item\": " << particleNs
+                  << ", \"mismatches\": " << countMismatches(b, refBodies) + countMismatches(p, refParticles) << "}"
+                  << (k + 1 < kernels.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}\n";
+    return 0;
+}
@@ -0,0 +1,362 @@
+// Headless benchmark: runs scripted scenes through PhysicsWorld and prints
+// one JSON document with throughput, per-phase timings and peak memory.
+//
+//   physics_bench [--scene NAME] [--steps N] [--threads N] [--trace FILE] [--record FILE]
+//
+// --trace writes the profiler's history (the last steps of the last scene
+// run) as a Chrome trace; it needs a PHYSICS_PROFILING build. --record
+// writes a Recorder file of the last scene run, for physics_replay.
+//
+// peak_rss_delta_kb is how far resident memory rose above its level at the
+// start of the scene. On Linux the high-water mark is reset before every
+// scene; elsewhere it is the process mark, so an earlier, larger scene hides
+// a smaller one's growth. Scenes run in deterministic mode; state_hash is the
+// world hash after the last step and must match across runs and thread counts.
+#include "Logger.hpp"
+#include "PhysicsWorld.hpp"
+#include "Profiler.hpp"
+#include "Recorder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+struct Scene {
+    std::string name;
+    size_t scale;
+    std::function<void(PhysicsWorld&, size_t)> setup;
+    // Called before every step, for scenes that keep spawning.
+    std::function<void(PhysicsWorld&, size_t, int)> perStep;
+};
+
+struct Result {
+    std::string name;
+    size_t scale = 0;
+    int steps = 0;
+    double seconds = 0;
+    StepTimings total;
+    size_t bodies = 0;
+    size_t particles = 0;
+    size_t contacts = 0;
+    long peakRssDeltaKb = 0;
+    std::uint64_t stateHash = 0;
+};
+
+// Width of a world that fits count objects of the given spacing in rows
+// roughly a third as tall as they are wide.
+float worldWidthFor(size_t count, float spacing) {
+    float columns = std::ceil(std::sqrt(static_cast<float>(count) * 3.0f));
+    return std::max(800.0f, columns * spacing);
+}
+
+void setupBoxes(PhysicsWorld& world, size_t count) {
+    const float spacing = 40.0f;
+    float width = worldWidthFor(count, spacing);
+    size_t columns = static_cast<size_t>(width / spacing);
+    world.setBounds(width, std::max(600.0f, (count / columns + 4) * spacing * 2.0f));
+    for (size_t i = 0; i < count; i++) {
+        float x = (i % columns) * spacing + 5.0f;
+        float y = (i / columns) * spacing + 5.0f;
+        world.createPolygon({{x, y}, {x + 30.0f, y}, {x + 30.0f, y + 25.0f}, {x, y + 25.0f}}, {0, 0}, sf::Color::Red);
+    }
+}
+
+void setupCircles(PhysicsWorld& world, size_t count) {
+    const float spacing = 30.0f;
+    float width = worldWidthFor(count, spacing);
+    size_t columns = static_cast<size_t>(width / spacing);
+    world.setBounds(width, std::max(600.0f, (count / columns + 4) * spacing * 2.0f));
+    for (size_t i = 0; i < count; i++) {
+        float jitter = (i % 7) * 0.5f;
+        float x = (i % columns) * spacing + 15.0f + jitter;
+        float y = (i / columns) * spacing + 15.0f;
+        world.createCircle({x, y}, 8.0f + (i % 5), {0, 0}, sf::Color::Blue);
+    }
+}
+
+void setupTriangles(PhysicsWorld& world, size_t count) {
+    const float spacing = 36.0f;
+    float width = worldWidthFor(count, spacing);
+    size_t columns = static_cast<size_t>(width / spacing);
+    float height = std::max(600.0f, (count / columns + 2) * 30.0f);
+    world.setBounds(width, height);
+    // Stacked columns, bottom row resting on the floor.
+    for (size_t i = 0; i < count; i++) {
+        float x = (i % columns) * spacing + 3.0f;
+        float yBottom = height - (i / columns) * 30.0f;
+        world.createPolygon({{x + 15.0f, yBottom - 28.0f}, {x, yBottom}, {x + 30.0f, yBottom}}, {0, 0}, sf::Color::Green);
+    }
+}
+
+void setupFountain(PhysicsWorld& world, size_t count) {
+    world.setBounds(1600.0f, 1200.0f);
+    for (int i = 0; i < 8; i++) {
+        float x = 150.0f + i * 180.0f;
+        world.createPolygon({{x, 900.0f}, {x + 120.0f, 900.0f}, {x + 120.0f, 930.0f}, {x, 930.0f}}, {0, 0}, sf::Color::Red);
+    }
+    world.setLiquidCapacity(count);
+}
+
+void fountainStep(PhysicsWorld& world, size_t count, int step) {
+    // Fill to capacity over the first second.
+    size_t perStep = std::max<size_t>(1, count / 120);
+    if (step < 120) {
+        for (int k = 0; k < 4; k++) {
+            world.spawnLiquidObjects({400.0f + k * 250.0f, 100.0f}, static_cast<int>(perStep / 4 + 1));
+        }
+    }
+}
+
+// count static tiles of rough ground, and a fixed 500 circles dropped onto
+// it; per-step cost should barely change with count.
+void setupTerrain(PhysicsWorld& world, size_t count) {
+    const float tile = 20.0f;
+    const size_t columns = 200;
+    size_t rows = (count + columns - 1) / columns;
+    float ground = 600.0f;
+    world.setBounds(columns * tile, ground + rows * tile + 50.0f);
+    for (size_t i = 0; i < count; i++) {
+        float x = (i % columns) * tile;
+        float y = ground + (i / columns) * tile + (i % columns % 7) * 3.0f;
+        BodyHandle handle = world.createPolygon({{x, y}, {x + tile, y}, {x + tile, y + tile}, {x, y + tile}}, {0, 0},
+                                                sf::Color(140, 140, 140));
+        world.setBodyType(handle, BodyType::STATIC);
+    }
+    for (size_t i = 0; i < 500; i++) {
+        float x = (i % 100) * 39.0f + 20.0f + (i % 3);
+        float y = (i / 100) * 40.0f + 20.0f;
+        world.createCircle({x, y}, 8.0f + (i % 5), {0, 0}, sf::Color::Blue);
+    }
+}
+
+// The same floor and 500 circles every time, plus count static tiles buried
+// below the floor where nothing reaches them. The dynamic work is identical
+// at every count, so step time should stay flat as count grows.
+void setupStaticField(PhysicsWorld& world, size_t count) {
+    const float tile = 20.0f;
+    const size_t columns = 200;
+    size_t rows = (count + columns - 1) / columns;
+    float ground = 600.0f;
+    float buried = ground + 4.0f * tile;
+    world.setBounds(columns * tile, buried + rows * tile + 50.0f);
+    auto addTile = [&world, tile](float x, float y) {
+        BodyHandle handle = world.createPolygon({{x, y}, {x + tile, y}, {x + tile, y + tile}, {x, y + tile}}, {0, 0},
+                                                sf::Color(140, 140, 140));
+        world.setBodyType(handle, BodyType::STATIC);
+    };
+    for (size_t i = 0; i < columns; i++) {
+        addTile(i * tile, ground);
+    }
+    for (size_t i = 0; i < count; i++) {
+        addTile((i % columns) * tile, buried + (i / columns) * tile);
+    }
+    for (size_t i = 0; i < 500; i++) {
+        float x = (i % 100) * 39.0f + 20.0f + (i % 3);
+        float y = (i / 100) * 40.0f + 20.0f;
+        world.createCircle({x, y}, 8.0f + (i % 5), {0, 0}, sf::Color::Blue);
+    }
+}
+
+// count circles on a static floor in bounds centred on the origin, with the
+// walls off and the spatial hash, plus a few strays flung far outside the
+// bounds. Exercises negative cell coordinates and ones beyond int range.
+void setupOpenWorld(PhysicsWorld& world, size_t count) {
+    world.setBounds(sf::FloatRect(-2000.0f, -1500.0f, 4000.0f, 3000.0f));
+    world.setWallsEnabled(false);
+    world.setBroadPhase(BroadPhaseType::SPATIAL_HASH);
+    BodyHandle floor = world.createPolygon({{-2000, 1000}, {2000, 1000}, {2000, 1040}, {-2000, 1040}}, {0, 0},
+                                           sf::Color(140, 140, 140));
+    world.setBodyType(floor, BodyType::STATIC);
+    for (size_t i = 0; i < count; i++) {
+        float x = -1950.0f + (i % 150) * 26.0f + (i % 3);
+        float y = 950.0f - (i / 150) * 26.0f;
+        world.createCircle({x, y}, 8.0f + (i % 5), {0, 0}, sf::Color::Blue);
+    }
+    for (int i = 0; i < 4; i++) {
+        float sign = i % 2 ? 1.0f : -1.0f;
+        world.createCircle({sign * 1e12f, -1e12f * (i / 2)}, 10.0f, {sign * 1e6f, 0}, sf::Color::Red);
+    }
+}
+
+// Reads a "Name:   123 kB" line from /proc/self/status; -1 if unavailable.
+long procStatusKb(const char* name) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(name);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, name) == 0 && line.size() > length && line[length] == ':') {
+            return std::strtol(line.c_str() + length + 1, nullptr, 10);
+        }
+    }
+    return -1;
+}
+
+long currentRssKb() {
+    return procStatusKb("VmRSS");
+}
+
+// Starts a new high-water mark at the current RSS (Linux 4.0+). Memory the
+// previous scene freed is handed back first, or this scene would reuse it
+// without RSS rising.
+void resetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+long peakRssKb() {
+    long peak = procStatusKb("VmHWM");
+    if (peak >= 0) {
+        return peak;
+    }
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+Result runScene(const Scene& scene, int steps, size_t threads, const std::string& recordPath) {
+    resetPeakRss();
+    long baseRssKb = currentRssKb();
+    if (baseRssKb < 0) {
+        baseRssKb = peakRssKb();
+    }
+
+    PhysicsWorld world(800.0f, 600.0f);
+    world.setDeterministic(true);
+    if (threads > 0) {
+        world.setThreadCount(threads);
+    }
+    Recorder recorder;
+    if (!recordPath.empty()) {
+        recorder.start(recordPath, world);
+    }
+    scene.setup(world, scene.scale);
+
+    Result result;
+    result.name = scene.name;
+    result.scale = scene.scale;
+    result.steps = steps;
+
+    const float dt = world.getFixedTimestep();
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        if (scene.perStep) {
+            scene.perStep(world, scene.scale, s);
+        }
+        world.step(dt);
+        PROFILE_FRAME();
+
+        const StepTimings& t = world.getStepTimings();
+        result.total.forces += t.forces;
+        result.total.broadPhase += t.broadPhase;
+        result.total.narrowPhase += t.narrowPhase;
+        result.total.solve += t.solve;
+        result.total.integrate += t.integrate;
+        result.total.particles += t.particles;
+        result.contacts += world.getCollisionStats().contacts;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.bodies = world.getBodies().size();
+    result.particles = world.getParticles().size();
+    result.peakRssDeltaKb = std::max(0L, peakRssKb() - baseRssKb);
+    result.stateHash = world.getStepHash();
+    return result;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results, size_t threads) {
+    out << "{\n  \"threads\": " << threads << ",\n  \"scenes\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double perStep = 1.0 / r.steps;
+        out << "    {\"name\": \"" << r.name << "\", \"scale\": " << r.scale
+            << ", \"steps\": " << r.steps
+            << ", \"steps_per_sec\": " << (r.seconds > 0 ? r.steps / r.seconds : 0.0)
+            << ", \"bodies\": " << r.bodies << ", \"particles\": " << r.particles
+            << ", \"avg_contacts\": " << r.contacts * perStep
+            << ",\n     \"phase_ms\": {\"forces\": " << r.total.forces * perStep
+            << ", \"broad_phase\": " << r.total.broadPhase * perStep
+            << ", \"narrow_phase\": " << r.total.narrowPhase * perStep
+            << ", \"resolve\": " << r.total.solve * perStep
+            << ", \"integrate\": " << r.total.integrate * perStep
+            << ", \"particles\": " << r.total.particles * perStep << "}"
+            << ", \"peak_rss_delta_kb\": " << r.peakRssDeltaKb
+            << ", \"state_hash\": \"" << std::hex << r.stateHash << std::dec << "\"}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string only;
+    int steps = 600;
+    size_t threads = 0;
+    std::string tracePath;
+    std::string recordPath;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--scene") && i + 1 < argc) only = argv[++i];
+        else if (!std::strcmp(argv[i], "--steps") && i + 1 < argc) steps = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc) tracePath = argv[++i];
+        else if (!std::strcmp(argv[i], "--record") && i + 1 < argc) recordPath = argv[++i];
+        else {
+            std::cerr << "usage: physics_bench [--scene NAME] [--steps N] [--threads N] [--trace FILE] [--record FILE]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Scene> scenes;
+    for (size_t n : {100, 500, 2000}) {
+        scenes.push_back({"falling_boxes", n, setupBoxes, nullptr});
+        scenes.push_back({"circle_pile", n, setupCircles, nullptr});
+        scenes.push_back({"triangle_stack", n, setupTriangles, nullptr});
+    }
+    for (size_t n : {1000, 10000, 50000}) {
+        scenes.push_back({"liquid_fountain", n, setupFountain, fountainStep});
+    }
+    for (size_t n : {0, 10000, 50000}) {
+        scenes.push_back({"static_terrain", n, setupTerrain, nullptr});
+    }
+    for (size_t n : {0, 10000, 100000}) {
+        scenes.push_back({"static_field", n, setupStaticField, nullptr});
+    }
+    for (size_t n : {500, 2000}) {
+        scenes.push_back({"open_world", n, setupOpenWorld, nullptr});
+    }
+
+    // Keep engine chatter out of the JSON on stdout.
+    Logger::get().setLevel(LogLevel::WARNING);
+    Logger::get().setOutput(std::cerr);
+
+    std::vector<Result> results;
+    for (const Scene& scene : scenes) {
+        if (!only.empty() && scene.name != only) continue;
+        results.push_back(runScene(scene, steps, threads, recordPath));
+    }
+
+    size_t threadCount = threads > 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    writeJson(std::cout, results, threadCount);
+
+    if (!tracePath.empty() && !Profiler::get().writeChromeTrace(tracePath)) {
+        std::cerr << "could not write " << tracePath << "\n";
+        return 1;
+    }
+    return 0;
+}
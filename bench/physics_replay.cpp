@@ -0,0 +1,73 @@
+// Headless replay of a Recorder file (viewer: R; physics_bench --record).
+// Re-simulates the session as fast as the world steps and prints one JSON
+// document with throughput, keyframe checks and the final state hash.
+//
+//   physics_replay FILE [--keyframe K] [--steps N] [--threads N]
+//
+// --keyframe starts from keyframe K instead of the beginning; --steps stops
+// after N steps. divergences counts keyframes whose state hash the replay
+// did not reproduce; it should be 0 for a recording made by the same build.
+#include "Logger.hpp"
+#include "PhysicsWorld.hpp"
+#include "Replay.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string path;
+    size_t keyframe = 0;
+    std::uint64_t maxSteps = UINT64_MAX;
+    size_t threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--keyframe") && i + 1 < argc) keyframe = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--steps") && i + 1 < argc) maxSteps = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (path.empty() && argv[i][0] != '-') path = argv[i];
+        else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "usage: physics_replay FILE [--keyframe K] [--steps N] [--threads N]\n";
+        return 1;
+    }
+
+    Logger::get().setLevel(LogLevel::WARNING);
+    Logger::get().setOutput(std::cerr);
+
+    Replay replay;
+    if (!replay.open(path)) {
+        Logger::get().flush();
+        return 1;
+    }
+    PhysicsWorld world(1.0f, 1.0f);
+    if (threads > 0) {
+        world.setThreadCount(threads);
+    }
+    if (!replay.seek(world, keyframe)) {
+        std::cerr << "no keyframe " << keyframe << " (recording has " << replay.getKeyframeCount() << ")\n";
+        return 1;
+    }
+
+    std::uint64_t startStep = world.getStepCount();
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t steps = replay.run(world, maxSteps);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "{\n  \"file\": \"" << path << "\", \"keyframes\": " << replay.getKeyframeCount()
+              << ", \"start_keyframe\": " << keyframe << ", \"start_step\": " << startStep
+              << ",\n  \"steps\": " << steps << ", \"seconds\": " << seconds
+              << ", \"steps_per_sec\": " << (seconds > 0 ? steps / seconds : 0.0)
+              << ",\n  \"verified_keyframes\": " << replay.getVerifiedKeyframes()
+              << ", \"divergences\": " << replay.getDivergences()
+              << ", \"finished\": " << (replay.isFinished() ? "true" : "false")
+              << ",\n  \"bodies\": " << world.getBodies().size() << ", \"particles\": " << world.getParticles().size()
+              << ", \"state_hash\": \"" << std::hex << world.computeStateHash() << std::dec << "\"\n}\n";
+    Logger::get().flush();
+    return replay.getDivergences() == 0 ? 0 : 2;
+}
@@ -0,0 +1,210 @@
+// Microbenchmark for the separating axis test between polygons. Times the
+// old per-axis path (edge axes normalized with sqrt, one scalar dot per
+// vertex per axis) against the batched projection kernels on rotated boxes
+// and triangles, and checks that every kernel agrees with the scalar one.
+//
+//   sat_bench [--pairs N] [--rounds N]
+//
+// Prints one JSON document; ns_per_test is the time for one full SAT query.
+#include "SatKernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Polygon {
+    std::vector<sf::Vector2f> vertices;
+    std::vector<sf::Vector2f> normals;  // unit, local space
+    sf::Vector2f rotation;              // (cos, sin), as in ShapeView
+};
+
+struct Pair {
+    Polygon a;
+    Polygon b;
+};
+
+float dot(const sf::Vector2f& a, const sf::Vector2f& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+Polygon makePolygon(const std::vector<sf::Vector2f>& local, sf::Vector2f position, float angle) {
+    Polygon poly;
+    float c = std::cos(angle), s = std::sin(angle);
+    poly.rotation = sf::Vector2f(c, s);
+    for (size_t k = 0; k < local.size(); k++) {
+        const sf::Vector2f& p = local[k];
+        poly.vertices.push_back({position.x + c * p.x - s * p.y, position.y + s * p.x + c * p.y});
+        sf::Vector2f edge = local[(k + 1) % local.size()] - p;
+        float length = std::sqrt(dot(edge, edge));
+        poly.normals.push_back({edge.y / length, -edge.x / length});
+    }
+    return poly;
+}
+
+// Pairs close enough that about half of them overlap.
+std::vector<Pair> makePairs(const std::vector<sf::Vector2f>& local, size_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> offset(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::vector<Pair> pairs;
+    for (size_t i = 0; i < count; i++) {
+        sf::Vector2f p(i * 200.0f, 0.0f);
+        pairs.push_back({makePolygon(local, p, angle(rng)),
+                         makePolygon(local, p + sf::Vector2f(offset(rng), offset(rng)), angle(rng))});
+    }
+    return pairs;
+}
+
+// The path polygonVsPolygon used before the kernels: each axis rebuilt from
+// the edge and normalized, then both shapes projected one dot at a time.
+bool legacyOverlapOnAxis(const sf::Vector2f& axis, const Polygon& a, const Polygon& b, float& overlap) {
+    float minA = std::numeric_limits<float>::max(), maxA = std::numeric_limits<float>::lowest();
+    float minB = std::numeric_limits<float>::max(), maxB = std::numeric_limits<float>::lowest();
+    for (const sf::Vector2f& v : a.vertices) {
+        float proj = dot(v, axis);
+        minA = std::min(minA, proj);
+        maxA = std::max(maxA, proj);
+    }
+    for (const sf::Vector2f& v : b.vertices) {
+        float proj = dot(v, axis);
+        minB = std::min(minB, proj);
+        maxB = std::max(maxB, proj);
+    }
+    if (maxA < minB || maxB < minA) return false;
+    overlap = std::min(maxA - minB, maxB - minA);
+    return true;
+}
+
+float legacySat(const Pair& pair) {
+    float minOverlap = std::numeric_limits<float>::max();
+    for (const Polygon* poly : {&pair.a, &pair.b}) {
+        size_t n = poly->vertices.size();
+        for (size_t k = 0; k < n; k++) {
+            sf::Vector2f edge = poly->vertices[(k + 1) % n] - poly->vertices[k];
+            float length = std::sqrt(dot(edge, edge));
+            sf::Vector2f axis(-edge.y / length, edge.x / length);
+            float overlap;
+            if (!legacyOverlapOnAxis(axis, pair.a, pair.b, overlap)) return -1.0f;
+            minOverlap = std::min(minOverlap, overlap);
+        }
+    }
+    return minOverlap;
+}
+
+// The current path: precomputed normals rotated into place, all axes of
+// both shapes projected in one kernel call per shape.
+float batchedSat(const Pair& pair, SatKernels::Kernel kernel) {
+    float axisX[SatKernels::MAX_AXES] = {}, axisY[SatKernels::MAX_AXES] = {};
+    float minA[SatKernels::MAX_AXES], maxA[SatKernels::MAX_AXES];
+    float minB[SatKernels::MAX_AXES], maxB[SatKernels::MAX_AXES];
+    size_t count = 0;
+    for (const Polygon* poly : {&pair.a, &pair.b}) {
+        for (const sf::Vector2f& n : poly->normals) {
+            axisX[count] = poly->rotation.x * n.x - poly->rotation.y * n.y;
+            axisY[count] = poly->rotation.y * n.x + poly->rotation.x * n.y;
+            count++;
+        }
+    }
+    SatKernels::project(kernel, pair.a.vertices.data(), pair.a.vertices.size(), axisX, axisY, count, minA, maxA);
+    SatKernels::project(kernel, pair.b.vertices.data(), pair.b.vertices.size(), axisX, axisY, count, minB, maxB);
+
+    float minOverlap = std::numeric_limits<float>::max();
+    for (size_t k = 0; k < count; k++) {
+        if (maxA[k] < minB[k] || maxB[k] < minA[k]) return -1.0f;
+        minOverlap = std::min(minOverlap, std::min(maxA[k] - minB[k], maxB[k] - minA[k]));
+    }
+    return minOverlap;
+}
+
+// Keeps the timed loops from being optimized away.
+volatile float sink;
+
+template <typename Fn>
+double nsPerTest(const std::vector<Pair>& pairs, int rounds, Fn&& test) {
+    float checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const Pair& pair : pairs) {
+            checksum += test(pair);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sink = checksum;
+    return seconds * 1e9 / (static_cast<double>(rounds) * pairs.size());
+}
+
+// Projections of every kernel must match the scalar kernel exactly.
+size_t countMismatches(const std::vector<Pair>& pairs, SatKernels::Kernel kernel) {
+    size_t mismatches = 0;
+    for (const Pair& pair : pairs) {
+        float x[SatKernels::MAX_AXES] = {}, y[SatKernels::MAX_AXES] = {};
+        size_t count = 0;
+        for (const sf::Vector2f& n : pair.b.normals) {
+            x[count] = n.x;
+            y[count] = n.y;
+            count++;
+        }
+        float lo[SatKernels::MAX_AXES], hi[SatKernels::MAX_AXES], refLo[SatKernels::MAX_AXES], refHi[SatKernels::MAX_AXES];
+        SatKernels::project(kernel, pair.a.vertices.data(), pair.a.vertices.size(), x, y, count, lo, hi);
+        SatKernels::projectScalar(pair.a.vertices.data(), pair.a.vertices.size(), x, y, count, refLo, refHi);
+        for (size_t k = 0; k < count; k++) {
+            if (lo[k] != refLo[k] || hi[k] != refHi[k]) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t pairCount = 4096;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--pairs") && i + 1 < argc) pairCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) rounds = std::atoi(argv[++i]);
+        else {
+            std::cerr << "usage: sat_bench [--pairs N] [--rounds N]\n";
+            return 1;
+        }
+    }
+
+    struct Shape {
+        const char* name;
+        std::vector<sf::Vector2f> local;
+    };
+    std::vector<Shape> shapes = {
+        {"box", {{-15, -12.5f}, {15, -12.5f}, {15, 12.5f}, {-15, 12.5f}}},
+        {"triangle", {{0, -18.7f}, {15, 9.3f}, {-15, 9.3f}}},
+    };
+    std::vector<SatKernels::Kernel> kernels;
+    for (SatKernels::Kernel k : {SatKernels::Kernel::Scalar, SatKernels::Kernel::Sse, SatKernels::Kernel::Avx2}) {
+        if (SatKernels::available(k)) kernels.push_back(k);
+    }
+
+    std::cout << "{\n  \"pairs\": " << pairCount << ", \"rounds\": " << rounds
+              << ", \"best\": \"" << SatKernels::name(SatKernels::best()) << "\",\n  \"shapes\": [\n";
+    for (size_t s = 0; s < shapes.size(); s++) {
+        std::vector<Pair> pairs = makePairs(shapes[s].local, pairCount);
+        double legacy = nsPerTest(pairs, rounds, legacySat);
+        std::cout << "    {\"name\": \"" << shapes[s].name << "\", \"legacy_ns_per_test\": " << legacy
+                  << ", \"kernels\": [";
+        for (size_t k = 0; k < kernels.size(); k++) {
+            SatKernels::Kernel kernel = kernels[k];
+            double ns = nsPerTest(pairs, rounds, [kernel](const Pair& p) { return batchedSat(p, kernel); });
+            std::cout << (k ? ", " : "") << "{\"kernel\": \"" << SatKernels::name(kernel)
+                      << "\", \"ns_per_test\": " << ns << ", \"speedup\": " << (ns > 0 ? legacy / ns : 0.0)
+                      << ", \"mismatches\": " << countMismatches(pairs, kernel) << "}";
+        }
+        std::cout << "]}" << (s + 1 < shapes.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}\n";
+    return 0;
+}
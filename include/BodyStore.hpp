@@ -0,0 +1,146 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include <map>
+#include "Forces.hpp"
+#include "ShapeDef.hpp"
+
+class Recorder;
+
+enum class BodyType : std::uint8_t {
+    DYNAMIC,     // moved by forces and contacts
+    STATIC,      // infinite mass, never moves; kept asleep and out of the broad phase
+    KINEMATIC    // infinite mass, moves only at the velocity it is given; never sleeps
+};
+
+struct BodyHandle {
+    static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+    std::uint32_t id = INVALID;
+    std::uint32_t generation = 0;
+
+    bool isValid() const { return id != INVALID; }
+    bool operator==(const BodyHandle& other) const { return id == other.id && generation == other.generation; }
+    bool operator!=(const BodyHandle& other) const { return !(*this == other); }
+};
+
+// Structure-of-arrays storage for rigid bodies. Every per-body quantity is a
+// parallel array indexed by dense body index. Geometry lives in shared
+// ShapeDefs; a body only adds its pose. Dense indices shift when bodies are
+// removed; handles do not.
+class BodyStore {
+public:
+    std::vector<float> posX, posY;     // centre of mass
+    std::vector<float> prevX, prevY;   // centre of mass at the start of the step
+    std::vector<float> velX, velY;
+    std::vector<float> accX, accY;
+    std::vector<float> angle, prevAngle;   // radians, clockwise on screen (y points down)
+    std::vector<float> angularVel;
+    std::vector<float> torque;         // accumulated until the next integration
+    std::vector<float> mass, invMass;
+    std::vector<float> inertia, invInertia;  // about the centre of mass
+    std::vector<ShapeRef> shapes;
+    std::vector<BodyShape> shape;      // copied from the ShapeDef for the hot loops
+    std::vector<float> radius;         // likewise; circles only
+    std::vector<float> density;
+    std::vector<AABB> aabbs;
+    std::vector<sf::Color> colors;
+    ForceArena forces;                 // per-body forces, not indexed by body
+    std::vector<std::uint8_t> awake;
+    std::vector<float> sleepTime;      // how long the body has been below the sleep velocity
+    std::vector<std::uint32_t> sleepGroup;  // island root when put to sleep; woken together
+    std::vector<std::uint8_t> bullet;  // swept against other bodies instead of just moved
+    std::vector<BodyType> type;
+    // Set by PhysicsWorld::setRecorder; PhysicsObject reports its setters to it.
+    Recorder* recorder = nullptr;
+
+    BodyStore() = default;
+    ~BodyStore();
+
+    BodyStore(const BodyStore&) = delete;
+    BodyStore& operator=(const BodyStore&) = delete;
+
+    BodyHandle createPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density);
+    BodyHandle createCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density);
+    // New body using an existing shape, centroid at position.
+    BodyHandle create(const ShapeRef& shapeDef, const sf::Vector2f& position, float angle,
+                      sf::Vector2f velocity, sf::Color color, float density);
+    // The live ShapeDef matching def (to within 1/1024 px) if there is one,
+    // else def itself, now shared. createPolygon/createCircle go through this.
+    ShapeRef intern(ShapeDef def);
+    void destroy(BodyHandle handle);
+    void clear();
+
+    size_t size() const { return posX.size(); }
+    bool contains(BodyHandle handle) const;
+    size_t indexOf(BodyHandle handle) const { return idToIndex[handle.id]; }
+    size_t indexOfId(std::uint32_t id) const { return idToIndex[id]; }
+    BodyHandle handleAt(size_t index) const;
+
+    sf::Vector2f position(size_t i) const { return sf::Vector2f(posX[i], posY[i]); }
+    sf::Vector2f previousPosition(size_t i) const { return sf::Vector2f(prevX[i], prevY[i]); }
+    sf::Vector2f velocity(size_t i) const { return sf::Vector2f(velX[i], velY[i]); }
+    size_t vertexCount(size_t i) const { return shapes[i]->vertices.size(); }
+    const sf::Vector2f* localVertices(size_t i) const { return shapes[i]->vertices.data(); }
+    // World-space vertices, computed on demand: only valid after
+    // refreshVertices(i) since the body last moved. Kept separate so the
+    // parallel narrow phase can read them without racing on the refresh.
+    const sf::Vector2f* vertices(size_t i) const { return vertexPool.data() + vertexOffset[i]; }
+    void refreshVertices(size_t i) {
+        if (verticesStale[i]) transformVertices(i);
+    }
+
+    // Call after changing a body's position or angle: updates its AABB and
+    // marks its world vertices stale.
+    void poseChanged(size_t i) {
+        verticesStale[i] = 1;
+        updateAABB(i);
+    }
+    void translate(size_t i, const sf::Vector2f& delta) {
+        posX[i] += delta.x;
+        posY[i] += delta.y;
+        poseChanged(i);
+    }
+    void updateAABB(size_t i);
+
+    // Static bodies stay asleep for good, which is what keeps them out of
+    // integration and of the pairs between sleeping bodies.
+    void wake(size_t i) {
+        if (type[i] == BodyType::STATIC) return;
+        awake[i] = 1;
+        sleepTime[i] = 0.0f;
+    }
+    void wakeAll();
+
+    // Static and kinematic bodies get zero mass and inverse mass, so forces
+    // skip them and contacts treat them as immovable. Turning a body
+    // dynamic gives it the mass of its shape and density back.
+    void setType(size_t i, BodyType bodyType);
+    // Changes whenever a static body is added, removed, retyped or moved,
+    // so a structure built over the statics knows to rebuild.
+    std::uint64_t getStaticRevision() const { return staticRevision; }
+    void staticsChanged() { staticRevision++; }
+
+private:
+    friend class Snapshot;   // reads and rebuilds the private state
+
+    std::vector<std::uint32_t> idToIndex;
+    std::vector<std::uint32_t> indexToId;
+    std::vector<std::uint32_t> generations;
+    std::vector<std::uint32_t> freeIds;
+    std::uint64_t staticRevision = 0;
+
+    // World-vertex cache, polygons only; body i owns vertexCount(i) entries
+    // from vertexOffset[i].
+    std::vector<sf::Vector2f> vertexPool;
+    std::vector<std::uint32_t> vertexOffset;
+    std::vector<std::uint8_t> verticesStale;
+
+    // Keyed by type, radius and local vertices, snapped to a small grid.
+    // Entries are dropped when the last body using the shape goes away.
+    std::map<std::vector<float>, std::weak_ptr<const ShapeDef>> shapeCache;
+
+    static std::vector<float> shapeKey(const ShapeDef& def);
+    void transformVertices(size_t i);
+};
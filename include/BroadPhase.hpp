@@ -0,0 +1,73 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "BodyStore.hpp"
+
+enum class BroadPhaseType {
+    SWEEP_AND_PRUNE,
+    SPATIAL_HASH
+};
+
+// Finds candidate pairs from the cached AABBs before the narrow phase runs.
+// build() takes the BodyStore AABB array and must be called whenever bodies
+// have moved; findPairs() and query() then work against that snapshot.
+class BroadPhase {
+public:
+    using Pair = std::pair<size_t, size_t>;
+
+    virtual ~BroadPhase() = default;
+    virtual void build(const std::vector<AABB>& bodies) = 0;
+    // Pairs are emitted with first < second, sorted, without duplicates.
+    virtual void findPairs(std::vector<Pair>& pairs) const = 0;
+    // Indices of bodies whose AABB overlaps the box, sorted, without duplicates.
+    virtual void query(const AABB& box, std::vector<size_t>& result) const = 0;
+    virtual BroadPhaseType getType() const = 0;
+};
+
+class SweepAndPrune : public BroadPhase {
+private:
+    std::vector<AABB> boxes;
+    std::vector<size_t> order;   // indices sorted by min.x, kept between frames
+    float maxWidth = 0.0f;
+
+public:
+    void build(const std::vector<AABB>& bodies) override;
+    void findPairs(std::vector<Pair>& pairs) const override;
+    void query(const AABB& box, std::vector<size_t>& result) const override;
+    BroadPhaseType getType() const override {
+        return BroadPhaseType::SWEEP_AND_PRUNE;
+    }
+};
+
+// Uniform grid. Each body is listed once per cell its AABB covers, in one
+// flat array sorted by (cell, body); a cell's members are a run of that
+// array. No hash map, so the order of everything is fixed by the input.
+class SpatialHash : public BroadPhase {
+private:
+    struct CellEntry {
+        std::int64_t cell;
+        size_t body;
+
+        bool operator<(const CellEntry& other) const {
+            return cell != other.cell ? cell < other.cell : body < other.body;
+        }
+    };
+
+    float cellSize;
+    std::vector<AABB> boxes;
+    std::vector<CellEntry> entries;
+
+    std::int64_t cellKey(int cx, int cy) const;
+    int cellCoord(float v) const;
+
+public:
+    explicit SpatialHash(float cellSize = 64.0f);
+    void build(const std::vector<AABB>& bodies) override;
+    void findPairs(std::vector<Pair>& pairs) const override;
+    void query(const AABB& box, std::vector<size_t>& result) const override;
+    BroadPhaseType getType() const override {
+        return BroadPhaseType::SPATIAL_HASH;
+    }
+};
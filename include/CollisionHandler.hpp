@@ -1,5 +1,7 @@
 #pragma once
-#include "RigidBody.hpp"
+#include "BodyStore.hpp"
+#include "ParticleSystem.hpp"
+#include <cstdint>
 
 class CollisionHandler {
 public:
@@ -8,18 +10,74 @@ public:
         sf::Vector2f normal;
         sf::Vector2f point;
         float penetrationDepth;
+        // Contact manifold: two points when faces press together, one for a
+        // corner or a circle. point is points[0].
+        sf::Vector2f points[2];
+        float depths[2];
+        // Which edges and vertices produced each point, so the solver can
+        // recognise the same point next step and reuse its impulses.
+        std::uint32_t features[2];
+        int pointCount;
         
-        CollisionInfo() : hasCollision(false), normal(0, 0), point(0, 0), penetrationDepth(0) {}
+        CollisionInfo() : hasCollision(false), normal(0, 0), point(0, 0), penetrationDepth(0), depths{0, 0}, features{0, 0}, pointCount(0) {}
     };
 
-    static CollisionInfo detectCollision(RigidBody* bodyA, RigidBody* bodyB);
-    static void resolveCollision(RigidBody* bodyA, RigidBody* bodyB, const CollisionInfo& info);
+    // Manifold points this far apart still count as touching, with a negative
+    // depth. Keeps the contact stable when a resting body tips very slightly.
+    static constexpr float CONTACT_MARGIN = 0.5f;
+
+    // bodyB of a contact against the world bounds.
+    static constexpr size_t WORLD = static_cast<size_t>(-1);
+
+    struct Contact {
+        size_t bodyA;
+        size_t bodyB;   // WORLD for the bounds; the normal then points into the wall
+        CollisionInfo info;
+        std::uint32_t wall = 0;  // which side of the bounds, for WORLD contacts
+
+        bool operator<(const Contact& other) const {
+            return bodyA != other.bodyA ? bodyA < other.bodyA : bodyB < other.bodyB;
+        }
+    };
+
+    // Geometry of one shape: world vertices from the BodyStore cache, edge
+    // normals from the shared ShapeDef, turned by rotation (cos, sin) when
+    // used. Circles only use com and radius.
+    struct ShapeView {
+        BodyShape type;
+        sf::Vector2f com;
+        float radius;
+        const sf::Vector2f* vertices;
+        const sf::Vector2f* normals;
+        sf::Vector2f rotation;
+        size_t vertexCount;
+    };
+
+    static ShapeView bodyShape(const BodyStore& store, size_t index);
+    static ShapeView particleShape(const ParticleSystem& particles, size_t index);
+
+    static CollisionInfo detectCollision(const ShapeView& shapeA, const ShapeView& shapeB);
+
+    // Translates moving along motion and finds the first fraction of it at
+    // which the shape touches target. Samples the stretch of the path where
+    // their bounding boxes overlap finely enough that neither shape can be
+    // skipped over, then bisects the first overlapping interval. Returns
+    // false if they never meet or already overlap at the start (that contact
+    // belongs to the solver). info is the contact just past the time of
+    // impact, with the normal pointing from moving to target.
+    static bool sweep(const ShapeView& moving, const sf::Vector2f& motion, const ShapeView& target,
+                      std::vector<sf::Vector2f>& scratch, float& toi, CollisionInfo& info);
+    // Smallest distance from the centre to the boundary.
+    static float minExtent(const ShapeView& shape);
+    static void resolveCollision(ParticleSystem& particles, size_t particle, BodyStore& store, size_t body, const CollisionInfo& info);
 
 private:
-    static CollisionInfo circleVsCircle(RigidBody* circleA, RigidBody* circleB);
-    static CollisionInfo polygonVsPolygon(RigidBody* polyA, RigidBody* polyB);
-    static CollisionInfo circleVsPolygon(RigidBody* circle, RigidBody* poly);
-    
-    static bool checkOverlapOnAxis(const sf::Vector2f& axis, const std::vector<sf::Vector2f>& vertsA, 
-                                  const std::vector<sf::Vector2f>& vertsB, float& overlap);
+    static CollisionInfo circleVsCircle(const ShapeView& circleA, const ShapeView& circleB);
+    static CollisionInfo polygonVsPolygon(const ShapeView& polyA, const ShapeView& polyB);
+    static CollisionInfo circleVsPolygon(const ShapeView& circle, const ShapeView& poly);
+
+    // Returns the impulse and positional correction to apply to B (A gets the negation,
+    // each scaled by its own inverse mass). False if the bodies are separating.
+    static bool computeResponse(const sf::Vector2f& relativeVelocity, float invMassA, float invMassB,
+                                const CollisionInfo& info, sf::Vector2f& impulse, sf::Vector2f& correction);
 };
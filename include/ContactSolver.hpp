@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <map>
+#include "BodyStore.hpp"
+#include "CollisionHandler.hpp"
+#include "ThreadPool.hpp"
+
+// Sequential-impulse solver with Coulomb friction. Impulses act at each
+// manifold point, so they spin bodies as well as push them. Contacts are first
+// grouped into islands of bodies that touch (union-find over the contact
+// graph). Islands share no bodies, so they are solved in parallel on the
+// pool; inside an island the contacts are iterated in sorted order, which
+// keeps results deterministic. Contacts with the world bounds, static and
+// kinematic bodies go through the same iterations with an immovable second
+// body, which joins no island and is never written, so several islands can
+// share it.
+//
+// Manifolds persist across steps in a pair table keyed by body ids. A point
+// whose feature id matches one from the previous step starts from that
+// point's accumulated impulses (warm starting), so resting contacts begin
+// each solve already close to the answer.
+class ContactSolver {
+public:
+    void solve(BodyStore& bodies, const std::vector<CollisionHandler::Contact>& contacts, float dt, ThreadPool& pool);
+
+    void setIterations(int n) { iterations = n; }
+    int getIterations() const { return iterations; }
+    void setWarmStarting(bool enabled) { warmStarting = enabled; }
+    bool isWarmStarting() const { return warmStarting; }
+    // Forgets every cached manifold; the next solve starts cold.
+    void clearPairs() { pairs.clear(); }
+    size_t getPairCount() const { return pairs.size(); }
+    // Contact points of the last solve that started from cached impulses.
+    size_t getWarmStartedPoints() const { return warmStartedPoints; }
+    size_t getIslandCount() const { return islandStart.empty() ? 0 : islandStart.size() - 1; }
+    // Root body of the island containing body, as of the last solve(). Bodies
+    // without contacts are their own root.
+    std::uint32_t islandRoot(size_t body) { return find(static_cast<std::uint32_t>(body)); }
+
+private:
+    friend class Snapshot;   // reads and rebuilds the private state
+
+    struct CachedPoint {
+        std::uint32_t feature;
+        float normalImpulse;
+        float tangentImpulse;
+    };
+
+    struct CachedManifold {
+        std::uint32_t generationA, generationB;
+        CachedPoint points[2];
+        int pointCount;
+        std::uint64_t lastStep;    // last solve the pair had a contact in
+    };
+
+    // Body ids, not dense indices, since those shift when bodies are removed.
+    // idB is BodyHandle::INVALID for the world, with wall telling the sides apart.
+    struct PairKey {
+        std::uint32_t idA, idB, wall;
+
+        bool operator<(const PairKey& other) const {
+            if (idA != other.idA) return idA < other.idA;
+            if (idB != other.idB) return idB < other.idB;
+            return wall < other.wall;
+        }
+    };
+
+    struct SolverPoint {
+        sf::Vector2f rA, rB;       // contact point relative to each centre of mass
+        float depth;
+        float velocityBias;
+        float normalMass;
+        float tangentMass;
+        float normalImpulse;       // accumulated over the iterations
+        float tangentImpulse;
+        std::uint32_t feature;
+    };
+
+    struct SolverContact {
+        size_t bodyA;
+        size_t bodyB;
+        float invMassA, invMassB;       // zero for the world
+        float invInertiaA, invInertiaB;
+        bool fixedB;                    // the world, or a static or kinematic body
+        sf::Vector2f normal;
+        SolverPoint points[2];
+        int pointCount;
+        CachedManifold* cache;     // this pair's entry in pairs; written back after solving
+    };
+
+    int iterations = 8;
+    bool warmStarting = true;
+    std::map<PairKey, CachedManifold> pairs;
+    std::uint64_t stepCount = 0;
+    size_t warmStartedPoints = 0;
+    static constexpr std::uint32_t NO_ISLAND = 0xFFFFFFFFu;
+    std::vector<std::uint32_t> parent;
+    std::vector<std::uint64_t> parentStamp;   // parent[i] holds for this solve only if this is islandStamp
+    std::uint64_t islandStamp = 0;
+    std::vector<std::uint32_t> islandOfRoot;  // NO_ISLAND between solves
+    std::vector<SolverContact> solverContacts;
+    std::vector<size_t> islandStart;     // island k owns islandContacts[islandStart[k], islandStart[k + 1])
+    std::vector<size_t> islandContacts;
+
+    std::uint32_t find(std::uint32_t body);
+    void unite(std::uint32_t a, std::uint32_t b);
+    void buildIslands(const BodyStore& bodies, const std::vector<CollisionHandler::Contact>& contacts);
+    CachedManifold& findPair(const BodyStore& bodies, const CollisionHandler::Contact& contact);
+    void prunePairs(const BodyStore& bodies);
+    void solveIsland(BodyStore& bodies, size_t island);
+    static float effectiveMass(const SolverContact& sc, const SolverPoint& sp, const sf::Vector2f& direction);
+    static void applyImpulse(BodyStore& bodies, const SolverContact& sc, const SolverPoint& sp, const sf::Vector2f& impulse);
+};
@@ -2,9 +2,12 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <string>
-#include "RigidBody.hpp"
-#include "Liquidfluid.hpp"
+#include <future>
+#include "PhysicsWorld.hpp"
 #include "GUI.hpp"
+#include "ProfilerOverlay.hpp"
+#include "Recorder.hpp"
+#include "Renderer.hpp"
 
 enum class ShapeType {
     RECTANGLE,
@@ -30,14 +33,18 @@ private:
 
 class Environment {
 public:
-    Environment(int width, int height, const std::string& title);
+    // The world is worldSize and starts with the window over its bottom-left
+    // corner; the camera pans over the rest.
+    Environment(int width, int height, const std::string& title, const sf::Vector2f& worldSize);
     void run();
     ShapeType getCurrentMode() const { return currMode; }
     sf::RenderWindow& getWindow() { return window; }
-    void addRigidBody(RigidBody* obj) { rigidobjs.push_back(obj); }
+    // Window pixel to world position through the camera.
+    sf::Vector2f toWorld(const sf::Vector2i& pixel) const { return window.mapPixelToCoords(pixel, mainView); }
     void spawnLiquidObjects(const sf::Vector2f& position, int count);
     void createRectangle(const sf::Vector2f& start, const sf::Vector2f& end);
     void createTriangle(const sf::Vector2f& start, const sf::Vector2f& end);
+    void createCircle(const sf::Vector2f& center, float radius);
 
 
     void togglePropertiesPanel();
@@ -49,6 +56,8 @@ public:
     float getLiquidFadeFactor() const { return liquidFadeFactor; }
     sf::Vector2f getGravity() const { return sf::Vector2f(gravityX, gravityY); }
 
+    PhysicsWorld& getWorld() { return world; }
+
 private:
     sf::RenderWindow window;
     sf::Clock clock;
@@ -56,10 +65,27 @@ private:
     sf::Font font;
     ShapeType currMode;
     UserInput userInput;
-    std::vector<RigidBody*> rigidobjs;
-    std::vector<LiquidParticle*> liquidobjs;
+    PhysicsWorld world;
+    Renderer renderer;
     bool isPaused = false;
 
+    sf::Text statsText;
+    void updateStatsText();
+
+    ProfilerOverlay profilerOverlay;
+    std::shared_ptr<gui::ToggleButton> profilerButton;
+    void saveProfilerTrace();
+
+    // F5 saves the scene and the properties panel, F9 loads them back.
+    std::future<bool> pendingSave;
+    void saveSnapshot();
+    void loadSnapshot();
+    void checkPendingSave();
+
+    // R starts and stops recording the session for physics_replay.
+    Recorder recorder;
+    void toggleRecording();
+
     std::shared_ptr<gui::ToggleButton> rectButton;
     std::shared_ptr<gui::ToggleButton> triangleButton;
     std::shared_ptr<gui::ToggleButton> circleButton;
@@ -74,6 +100,22 @@ private:
     std::shared_ptr<gui::Button> zoomInButton;
     std::shared_ptr<gui::Button> zoomOutButton;
 
+    // Arrow keys or dragging with the right button pan the camera. Only the
+    // bodies the broad phase finds under the view are drawn.
+    sf::Clock cameraClock;
+    bool panning = false;
+    sf::Vector2i panFrom;
+    std::vector<size_t> visibleBodies;
+    void updateCamera(float frameTime);
+    void panCamera(const sf::Vector2f& offset);
+    void clampCamera();
+    AABB visibleArea() const;
+
+    // S switches between placing dynamic and static shapes; statics are grey.
+    bool placeStatic = false;
+    sf::Color placingColor(sf::Color dynamicColor) const;
+    void placed(BodyHandle handle);
+
     void setupGUI();
     void setShapeType(ShapeType type);
     void update();
@@ -1,7 +1,8 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-
-class PhysicsObject;
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 
 enum class ForceType {
@@ -11,21 +12,56 @@ enum class ForceType {
     CUSTOM
 };
 
+// Extension point for forces the built-in types can't express. Evaluated
+// through a virtual call, so prefer a ForceDef where one fits.
 class Forces {
 public:
     virtual ~Forces() = default;
-    virtual sf::Vector2f computeForce(PhysicsObject& obj) = 0;
-    virtual ForceType getType() const = 0;
+    virtual sf::Vector2f computeForce(float mass, const sf::Vector2f& position, const sf::Vector2f& velocity) = 0;
+    virtual ForceType getType() const { return ForceType::CUSTOM; }
 };
 
+// A built-in per-body force as plain data. World gravity is not one of
+// these: it is a field PhysicsWorld applies to every body at once.
+struct ForceDef {
+    ForceType type = ForceType::GRAVITY;
+    sf::Vector2f vector;        // GRAVITY: extra acceleration; SPRING: world anchor
+    float coefficient = 0.0f;   // DRAG: force per unit velocity; SPRING: stiffness
+    float damping = 0.0f;       // SPRING: force per unit velocity
 
-class Gravity : public Forces {
-private:
-    sf::Vector2f gravity;
-public:
-    Gravity(float gx = 0.0f, float gy = 9.8f);
-    sf::Vector2f computeForce(PhysicsObject& obj) override;
-    ForceType getType() const override {
-        return ForceType::GRAVITY;
+    static ForceDef gravity(const sf::Vector2f& acceleration) { return {ForceType::GRAVITY, acceleration, 0.0f, 0.0f}; }
+    static ForceDef drag(float coefficient) { return {ForceType::DRAG, sf::Vector2f(), coefficient, 0.0f}; }
+    static ForceDef spring(const sf::Vector2f& anchor, float stiffness, float damping = 0.0f) {
+        return {ForceType::SPRING, anchor, stiffness, damping};
     }
 };
+
+// Every per-body force in one flat array, by value, instead of a heap
+// object per force per body. Entries name bodies by id, which survives the
+// dense-index shifts of removal. The arena owns CUSTOM forces; an entry
+// refers to one by its slot.
+class ForceArena {
+public:
+    struct Entry {
+        std::uint32_t body;
+        ForceDef force;
+        std::uint32_t custom;   // CUSTOM only: index into getCustom()
+    };
+
+    void add(std::uint32_t body, const ForceDef& force);
+    void addCustom(std::uint32_t body, std::unique_ptr<Forces> force);
+    void removeType(std::uint32_t body, ForceType type);
+    void removeBody(std::uint32_t body);
+    void clear();
+
+    size_t size() const { return entries.size(); }
+    const std::vector<Entry>& getEntries() const { return entries; }
+    Forces& getCustom(std::uint32_t slot) const { return *custom[slot]; }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<std::unique_ptr<Forces>> custom;
+
+    template <typename Pred>
+    void removeIf(Pred pred);
+};
@@ -242,15 +242,20 @@ class Slider : public Widget {
         }
         
         void setValue(float value) {
-            m_currentValue = std::max(m_minValue, std::min(m_maxValue, value));
-            updateHandlePosition();
-            updateText();
+            showValue(value);
             
             if (m_callback) {
                 m_callback(m_currentValue);
             }
         }
         
+        // Moves the handle without calling back.
+        void showValue(float value) {
+            m_currentValue = std::max(m_minValue, std::min(m_maxValue, value));
+            updateHandlePosition();
+            updateText();
+        }
+        
         float getValue() const {
             return m_currentValue;
         }
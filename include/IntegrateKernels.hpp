@@ -0,0 +1,103 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+
+enum class IntegrationScheme {
+    SEMI_IMPLICIT_EULER,   // full velocity kick, then drift
+    VELOCITY_VERLET        // half kick, drift, half kick with the new forces
+};
+
+// Batch integration kernels over structure-of-arrays state. Each call covers
+// the entries [begin, end) and handles the tail past the last whole lane with
+// scalar code, so the arrays need no padding.
+//
+// Like SatKernels, the vector kernels use the same separate multiplies and
+// adds as the scalar one and select results with masks instead of blending
+// arithmetically, so every kernel gives bit-identical results and the choice
+// never shows up in a state hash.
+namespace IntegrateKernels {
+
+enum class Kernel { Scalar, Sse, Avx2 };
+
+// Pointers to a BodyStore's arrays. Only entries whose mask byte is nonzero
+// are touched.
+struct Bodies {
+    const std::uint8_t* mask;
+    float* posX;
+    float* posY;
+    float* angle;
+    float* velX;
+    float* velY;
+    float* angularVel;
+    const float* accX;
+    const float* accY;
+    float* torque;
+    const float* invInertia;
+};
+
+// Circle bodies whose bounds follow from position and radius alone. boxes
+// is the AABB array as floats, four per body: min x, min y, max x, max y.
+struct Circles {
+    const std::uint8_t* mask;
+    float* posX;
+    float* posY;
+    const float* radius;
+    float* boxes;
+};
+
+// Pointers to a ParticleSystem's arrays; every entry is live.
+struct Particles {
+    float* posX;
+    float* posY;
+    float* velX;
+    float* velY;
+    const float* accX;
+    const float* accY;
+    const float* radius;
+};
+
+// The walls' inner edges. Infinite edges never touch anything.
+struct Bounds {
+    float left, top, right, bottom;
+};
+
+// Particle wall response: the normal velocity is reversed and scaled by
+// bounce (by 0.9 of it on the side walls), and the floor also scales the
+// tangential velocity by floorFriction.
+struct Walls {
+    Bounds bounds;
+    float bounce;
+    float floorFriction;
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PHYSICS_INTEGRATE_SSE 1
+#endif
+
+// The widest kernel both this build and the CPU running it support, chosen
+// once. AVX2 kernels are only built with PHYSICS_AVX2.
+Kernel best();
+const char* name(Kernel kernel);
+bool available(Kernel kernel);
+
+// Each of these runs scalar code when given a kernel that isn't available.
+
+// vel += acc * linearDt; angularVel += torque * invInertia * angularDt, and
+// the torque is used up.
+void accelerate(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float linearDt, float angularDt);
+// vel += acc * dt only; torque is left alone.
+void kick(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float dt);
+// pos += vel * dt; angle += angularVel * dt.
+void drift(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float dt);
+
+// Sets each circle's AABB from its position, then pushes any circle that
+// crosses an edge of bounds back inside, moving its AABB along with it.
+void boundCircles(Kernel kernel, const Circles& circles, size_t begin, size_t end, const Bounds& bounds);
+
+// One semi-implicit Euler step of acc plus gravity, then clamps each particle
+// inside the walls.
+void integrateParticles(Kernel kernel, const Particles& particles, size_t begin, size_t end,
+                        const sf::Vector2f& gravity, float dt, const Walls& walls);
+
+}
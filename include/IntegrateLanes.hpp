@@ -0,0 +1,244 @@
+#pragma once
+#include "IntegrateKernels.hpp"
+
+// Kernel bodies shared by IntegrateKernels.cpp and IntegrateKernelsAvx2.cpp,
+// which is the only source built with AVX2 enabled. Everything here has
+// internal linkage, so the linker can never keep an AVX2-compiled copy of a
+// function for the baseline kernels.
+namespace IntegrateKernels {
+
+#if defined(PHYSICS_AVX2)
+// Defined in IntegrateKernelsAvx2.cpp; only call them when available(Kernel::Avx2).
+void accelerateAvx2(const Bodies& bodies, size_t begin, size_t end, float linearDt, float angularDt);
+void kickAvx2(const Bodies& bodies, size_t begin, size_t end, float dt);
+void driftAvx2(const Bodies& bodies, size_t begin, size_t end, float dt);
+void boundCirclesAvx2(const Circles& circles, size_t begin, size_t end, const Bounds& bounds);
+void integrateParticlesAvx2(const Particles& particles, size_t begin, size_t end,
+                            const sf::Vector2f& gravity, float dt, const Walls& walls);
+#endif
+
+namespace {
+
+void accelerateScalar(const Bodies& b, size_t begin, size_t end, float linearDt, float angularDt) {
+    for (size_t i = begin; i < end; i++) {
+        if (!b.mask[i]) continue;
+        b.velX[i] += b.accX[i] * linearDt;
+        b.velY[i] += b.accY[i] * linearDt;
+        b.angularVel[i] += b.torque[i] * b.invInertia[i] * angularDt;
+        b.torque[i] = 0.0f;
+    }
+}
+
+void kickScalar(const Bodies& b, size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; i++) {
+        if (!b.mask[i]) continue;
+        b.velX[i] += b.accX[i] * dt;
+        b.velY[i] += b.accY[i] * dt;
+    }
+}
+
+void driftScalar(const Bodies& b, size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; i++) {
+        if (!b.mask[i]) continue;
+        b.posX[i] += b.velX[i] * dt;
+        b.posY[i] += b.velY[i] * dt;
+        b.angle[i] += b.angularVel[i] * dt;
+    }
+}
+
+void boundCirclesScalar(const Circles& c, size_t begin, size_t end, const Bounds& bounds) {
+    for (size_t i = begin; i < end; i++) {
+        if (!c.mask[i]) continue;
+        float r = c.radius[i];
+        float* box = c.boxes + 4 * i;
+        box[0] = c.posX[i] - r;
+        box[1] = c.posY[i] - r;
+        box[2] = c.posX[i] + r;
+        box[3] = c.posY[i] + r;
+
+        float adjustX = 0, adjustY = 0;
+        if (box[0] < bounds.left) adjustX = bounds.left - box[0];
+        else if (box[2] > bounds.right) adjustX = bounds.right - box[2];
+        if (box[1] < bounds.top) adjustY = bounds.top - box[1];
+        else if (box[3] > bounds.bottom) adjustY = bounds.bottom - box[3];
+
+        if (adjustX != 0 || adjustY != 0) {
+            c.posX[i] += adjustX;
+            c.posY[i] += adjustY;
+            box[0] += adjustX;
+            box[1] += adjustY;
+            box[2] += adjustX;
+            box[3] += adjustY;
+        }
+    }
+}
+
+void particlesScalar(const Particles& p, size_t begin, size_t end, const sf::Vector2f& gravity, float dt,
+                     const Walls& walls) {
+    const float sideBounce = -walls.bounce * 0.9f;
+    const float floorBounce = -walls.bounce;
+    const Bounds& b = walls.bounds;
+    for (size_t i = begin; i < end; i++) {
+        p.velX[i] += (gravity.x + p.accX[i]) * dt;
+        p.velY[i] += (gravity.y + p.accY[i]) * dt;
+        p.posX[i] += p.velX[i] * dt;
+        p.posY[i] += p.velY[i] * dt;
+
+        float r = p.radius[i];
+        if (p.posX[i] - r < b.left) {
+            p.posX[i] = b.left + r;
+            p.velX[i] *= sideBounce;
+        }
+        if (p.posX[i] + r > b.right) {
+            p.posX[i] = b.right - r;
+            p.velX[i] *= sideBounce;
+        }
+        if (p.posY[i] - r < b.top) {
+            p.posY[i] = b.top + r;
+            p.velY[i] *= floorBounce;
+        }
+        if (p.posY[i] + r > b.bottom) {
+            p.posY[i] = b.bottom - r;
+            p.velY[i] *= floorBounce;
+            p.velX[i] *= walls.floorFriction;
+        }
+    }
+}
+
+// The vector kernels are written once against lane types (Sse in
+// IntegrateKernels.cpp, Avx2 in IntegrateKernelsAvx2.cpp). mask()
+// widens WIDTH mask bytes to all-ones or all-zero lanes; bits() packs a mask
+// into one bit per lane.
+template <typename L>
+void accelerateLanes(const Bodies& b, size_t begin, size_t end, float linearDt, float angularDt) {
+    typename L::V ldt = L::set1(linearDt), adt = L::set1(angularDt), zero = L::zero();
+    size_t i = begin;
+    for (; i + L::WIDTH <= end; i += L::WIDTH) {
+        typename L::V m = L::mask(b.mask + i);
+        if (L::bits(m) == 0) continue;
+        typename L::V vx = L::load(b.velX + i), vy = L::load(b.velY + i), w = L::load(b.angularVel + i);
+        typename L::V torque = L::load(b.torque + i);
+        L::store(b.velX + i, L::select(m, L::add(vx, L::mul(L::load(b.accX + i), ldt)), vx));
+        L::store(b.velY + i, L::select(m, L::add(vy, L::mul(L::load(b.accY + i), ldt)), vy));
+        L::store(b.angularVel + i,
+                 L::select(m, L::add(w, L::mul(L::mul(torque, L::load(b.invInertia + i)), adt)), w));
+        L::store(b.torque + i, L::select(m, zero, torque));
+    }
+    accelerateScalar(b, i, end, linearDt, angularDt);
+}
+
+template <typename L>
+void kickLanes(const Bodies& b, size_t begin, size_t end, float dt) {
+    typename L::V h = L::set1(dt);
+    size_t i = begin;
+    for (; i + L::WIDTH <= end; i += L::WIDTH) {
+        typename L::V m = L::mask(b.mask + i);
+        if (L::bits(m) == 0) continue;
+        typename L::V vx = L::load(b.velX + i), vy = L::load(b.velY + i);
+        L::store(b.velX + i, L::select(m, L::add(vx, L::mul(L::load(b.accX + i), h)), vx));
+        L::store(b.velY + i, L::select(m, L::add(vy, L::mul(L::load(b.accY + i), h)), vy));
+    }
+    kickScalar(b, i, end, dt);
+}
+
+template <typename L>
+void driftLanes(const Bodies& b, size_t begin, size_t end, float dt) {
+    typename L::V h = L::set1(dt);
+    size_t i = begin;
+    for (; i + L::WIDTH <= end; i += L::WIDTH) {
+        typename L::V m = L::mask(b.mask + i);
+        if (L::bits(m) == 0) continue;
+        typename L::V x = L::load(b.posX + i), y = L::load(b.posY + i), a = L::load(b.angle + i);
+        L::store(b.posX + i, L::select(m, L::add(x, L::mul(L::load(b.velX + i), h)), x));
+        L::store(b.posY + i, L::select(m, L::add(y, L::mul(L::load(b.velY + i), h)), y));
+        L::store(b.angle + i, L::select(m, L::add(a, L::mul(L::load(b.angularVel + i), h)), a));
+    }
+    driftScalar(b, i, end, dt);
+}
+
+template <typename L>
+void boundCirclesLanes(const Circles& c, size_t begin, size_t end, const Bounds& bounds) {
+    typename L::V zero = L::zero();
+    typename L::V left = L::set1(bounds.left), top = L::set1(bounds.top);
+    typename L::V right = L::set1(bounds.right), bottom = L::set1(bounds.bottom);
+    size_t i = begin;
+    for (; i + L::WIDTH <= end; i += L::WIDTH) {
+        typename L::V m = L::mask(c.mask + i);
+        int lanes = L::bits(m);
+        if (lanes == 0) continue;
+        typename L::V x = L::load(c.posX + i), y = L::load(c.posY + i), r = L::load(c.radius + i);
+        typename L::V minX = L::sub(x, r), minY = L::sub(y, r), maxX = L::add(x, r), maxY = L::add(y, r);
+
+        typename L::V adjustX = L::select(L::less(minX, left), L::sub(left, minX),
+                                          L::select(L::greater(maxX, right), L::sub(right, maxX), zero));
+        typename L::V adjustY = L::select(L::less(minY, top), L::sub(top, minY),
+                                          L::select(L::greater(maxY, bottom), L::sub(bottom, maxY), zero));
+        typename L::V moved = L::either(L::notEqual(adjustX, zero), L::notEqual(adjustY, zero));
+        x = L::select(moved, L::add(x, adjustX), x);
+        y = L::select(moved, L::add(y, adjustY), y);
+        minX = L::select(moved, L::add(minX, adjustX), minX);
+        minY = L::select(moved, L::add(minY, adjustY), minY);
+        maxX = L::select(moved, L::add(maxX, adjustX), maxX);
+        maxY = L::select(moved, L::add(maxY, adjustY), maxY);
+
+        // Only a group with bodies left out needs the old values back.
+        if (lanes != L::ALL) {
+            typename L::V oldMinX, oldMinY, oldMaxX, oldMaxY;
+            L::loadBoxes(c.boxes + 4 * i, oldMinX, oldMinY, oldMaxX, oldMaxY);
+            x = L::select(m, x, L::load(c.posX + i));
+            y = L::select(m, y, L::load(c.posY + i));
+            minX = L::select(m, minX, oldMinX);
+            minY = L::select(m, minY, oldMinY);
+            maxX = L::select(m, maxX, oldMaxX);
+            maxY = L::select(m, maxY, oldMaxY);
+        }
+        L::store(c.posX + i, x);
+        L::store(c.posY + i, y);
+        L::storeBoxes(c.boxes + 4 * i, minX, minY, maxX, maxY);
+    }
+    boundCirclesScalar(c, i, end, bounds);
+}
+
+template <typename L>
+void particlesLanes(const Particles& p, size_t begin, size_t end, const sf::Vector2f& gravity, float dt,
+                    const Walls& walls) {
+    typename L::V h = L::set1(dt), gx = L::set1(gravity.x), gy = L::set1(gravity.y);
+    typename L::V left = L::set1(walls.bounds.left), top = L::set1(walls.bounds.top);
+    typename L::V right = L::set1(walls.bounds.right), bottom = L::set1(walls.bounds.bottom);
+    typename L::V sideBounce = L::set1(-walls.bounce * 0.9f), floorBounce = L::set1(-walls.bounce);
+    typename L::V friction = L::set1(walls.floorFriction);
+    size_t i = begin;
+    for (; i + L::WIDTH <= end; i += L::WIDTH) {
+        typename L::V vx = L::add(L::load(p.velX + i), L::mul(L::add(gx, L::load(p.accX + i)), h));
+        typename L::V vy = L::add(L::load(p.velY + i), L::mul(L::add(gy, L::load(p.accY + i)), h));
+        typename L::V x = L::add(L::load(p.posX + i), L::mul(vx, h));
+        typename L::V y = L::add(L::load(p.posY + i), L::mul(vy, h));
+        typename L::V r = L::load(p.radius + i);
+
+        // The walls in the same order as the scalar kernel, each seeing the
+        // previous one's result.
+        typename L::V hit = L::less(L::sub(x, r), left);
+        x = L::select(hit, L::add(left, r), x);
+        vx = L::select(hit, L::mul(vx, sideBounce), vx);
+        hit = L::greater(L::add(x, r), right);
+        x = L::select(hit, L::sub(right, r), x);
+        vx = L::select(hit, L::mul(vx, sideBounce), vx);
+        hit = L::less(L::sub(y, r), top);
+        y = L::select(hit, L::add(top, r), y);
+        vy = L::select(hit, L::mul(vy, floorBounce), vy);
+        hit = L::greater(L::add(y, r), bottom);
+        y = L::select(hit, L::sub(bottom, r), y);
+        vy = L::select(hit, L::mul(vy, floorBounce), vy);
+        vx = L::select(hit, L::mul(vx, friction), vx);
+
+        L::store(p.velX + i, vx);
+        L::store(p.velY + i, vy);
+        L::store(p.posX + i, x);
+        L::store(p.posY + i, y);
+    }
+    particlesScalar(p, i, end, gravity, dt, walls);
+}
+
+}
+
+}
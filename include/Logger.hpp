@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+enum class LogCategory {
+    WORLD,
+    VIEWER,
+    PROFILER,
+    COUNT
+};
+
+// Asynchronous logger. Callers format into a fixed-size slot of a bounded
+// lock-free queue; a background thread drains it to the output stream, so a
+// log call never blocks on I/O. When the queue is full the message is dropped
+// and counted rather than stalling the caller.
+//
+// Use the LOG macro, which skips formatting entirely for disabled messages:
+//     LOG(LogCategory::WORLD, LogLevel::INFO) << "created " << n << " bodies";
+class Logger {
+public:
+    static constexpr size_t CAPACITY = 4096;
+    static constexpr size_t MAX_MESSAGE = 240;
+
+    static Logger& get();
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void setLevel(LogLevel level) { minLevel = static_cast<int>(level); }
+    LogLevel getLevel() const { return static_cast<LogLevel>(minLevel.load()); }
+    void setCategoryEnabled(LogCategory category, bool enabled);
+    bool isEnabled(LogCategory category, LogLevel level) const;
+
+    // Messages already queued still go to the previous stream, which is no
+    // longer touched once this returns.
+    void setOutput(std::ostream& stream);
+
+    void log(LogCategory category, LogLevel level, const char* text, size_t length);
+    // Blocks until everything queued so far has been written.
+    void flush();
+    uint64_t getDroppedCount() const { return dropped; }
+
+    static const char* levelName(LogLevel level);
+    static const char* categoryName(LogCategory category);
+
+private:
+    Logger();
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogCategory category;
+        LogLevel level;
+        uint16_t length;
+        char text[MAX_MESSAGE];
+    };
+
+    bool pop(Slot*& slot);
+    bool hasPending() const;
+    void drain();
+    void run();
+
+    // Bounded multi-producer queue (Vyukov): each slot's sequence number says
+    // whether it is free for the producer at that position or ready for the
+    // consumer.
+    std::array<Slot, CAPACITY> slots;
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0;
+    std::atomic<size_t> written{0};
+
+    std::atomic<int> minLevel{static_cast<int>(LogLevel::INFO)};
+    std::atomic<uint32_t> enabledCategories{~0u};
+    std::atomic<uint64_t> dropped{0};
+    std::mutex outputMutex;   // held by the drain thread while it writes
+    std::ostream* output;
+
+    // The drain thread sleeps on wake when the queue is empty; producers only
+    // take wakeMutex to notify when it is actually waiting.
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::atomic<bool> waiting{false};
+    std::atomic<bool> running{true};
+    std::thread worker;
+};
+
+// Collects one message and hands it to the logger when it goes out of scope.
+class LogLine {
+public:
+    LogLine(LogCategory category, LogLevel level) : category(category), level(level) {}
+    ~LogLine();
+
+    template <typename T>
+    LogLine& operator<<(const T& value) {
+        stream << value;
+        return *this;
+    }
+
+private:
+    LogCategory category;
+    LogLevel level;
+    std::ostringstream stream;
+};
+
+#define LOG(category, level) \
+    if (!Logger::get().isEnabled(category, level)) {} else LogLine(category, level)
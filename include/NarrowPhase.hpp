@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+#include "BodyStore.hpp"
+#include "BroadPhase.hpp"
+#include "CollisionHandler.hpp"
+#include "ThreadPool.hpp"
+
+// Runs CollisionHandler::detectCollision over the broad-phase pairs on a
+// thread pool. Each thread appends to its own buffer; the buffers are then
+// merged and sorted by body pair, so the output does not depend on the
+// thread count or on which thread handled which pair. Contacts between a
+// dynamic body and another kind name the dynamic one as bodyA.
+class NarrowPhase {
+public:
+    void run(BodyStore& bodies, const std::vector<BroadPhase::Pair>& pairs,
+             ThreadPool& pool, std::vector<CollisionHandler::Contact>& contacts);
+
+private:
+    std::vector<std::vector<CollisionHandler::Contact>> threadContacts;
+};
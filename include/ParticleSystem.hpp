@@ -0,0 +1,101 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <random>
+#include "BodyStore.hpp"
+#include "IntegrateKernels.hpp"
+#include "ThreadPool.hpp"
+
+enum class LiquidModel {
+    BALLISTIC,   // independent particles, gravity only
+    SPH          // smoothed-particle hydrodynamics
+};
+
+struct SPHSettings {
+    float kernelRadius = 12.0f;
+    float restDensity = 0.8f;      // mass per square pixel, same units as particle density
+    float stiffness = 200000.0f;   // pressure = stiffness * (density - restDensity)
+    float viscosity = 0.8f;
+};
+
+// Fixed-capacity pool of liquid particles stored as parallel arrays. Live
+// particles are packed in [0, size()); a dead particle is replaced by the
+// last live one, so retiring is O(1) and iteration never skips holes. All
+// particles share one gravity field instead of carrying their own forces.
+// In SPH mode neighbours are found through a uniform grid with cell size
+// equal to the kernel radius, rebuilt each substep with a counting sort. The
+// grid covers wherever the particles are, not the world, so it stays small
+// in a large or open world.
+class ParticleSystem {
+public:
+    // Upper bound on setCapacity(), so a bad file or replay can't ask for
+    // an unbounded allocation.
+    static constexpr size_t MAX_CAPACITY = size_t(1) << 21;
+
+    std::vector<float> posX, posY;
+    std::vector<float> prevX, prevY;
+    std::vector<float> velX, velY;
+    std::vector<float> radius;
+    std::vector<float> mass, invMass;
+    std::vector<float> age, lifetime;
+    std::vector<float> density, pressure;
+    std::vector<float> accX, accY;
+
+    explicit ParticleSystem(size_t capacity = 100000);
+
+    // Spawns up to count particles at position; returns how many fit. Sizes,
+    // jitter and lifetimes are drawn from rng, which the caller owns so a
+    // seeded world spawns the same particles every run.
+    size_t spawn(const sf::Vector2f& position, size_t count, std::mt19937& rng);
+    // Particles bounce off the edges of bounds, which may be infinite.
+    void update(float dt, const IntegrateKernels::Bounds& bounds);
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return posX.size(); }
+    // Clamped to MAX_CAPACITY.
+    void setCapacity(size_t capacity);
+
+    // SPH passes run on this pool when set, inline otherwise.
+    void setThreadPool(ThreadPool* p) { pool = p; }
+
+    void setGravity(const sf::Vector2f& g) { gravity = g; }
+    void setColor(sf::Color c) { color = c; }
+    sf::Color getColor() const { return color; }
+    // Material density of new particles; also the SPH rest density.
+    void setDensity(float d) { particleDensity = d; sph.restDensity = d; }
+
+    void setModel(LiquidModel m) { model = m; }
+    LiquidModel getModel() const { return model; }
+    void setSPHSettings(const SPHSettings& settings) { sph = settings; }
+    const SPHSettings& getSPHSettings() const { return sph; }
+
+    sf::Vector2f position(size_t i) const { return sf::Vector2f(posX[i], posY[i]); }
+    sf::Vector2f velocity(size_t i) const { return sf::Vector2f(velX[i], velY[i]); }
+    AABB getAABB(size_t i) const;
+
+private:
+    friend class Snapshot;   // reads and rebuilds the private state
+
+    size_t count = 0;
+    sf::Vector2f gravity;
+    sf::Color color;
+    float particleDensity;
+    ThreadPool* pool = nullptr;
+
+    LiquidModel model = LiquidModel::SPH;
+    SPHSettings sph;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    std::vector<size_t> cellStart;   // gridWidth * gridHeight + 1 offsets into cellParticles
+    std::vector<size_t> cellParticles;
+    std::vector<size_t> cellFill;    // counting-sort cursors, reused across substeps
+    std::vector<int> particleCell;
+
+    void retire(size_t i);
+    void integrate(float dt, const IntegrateKernels::Bounds& bounds);
+    void buildGrid();
+    void computeSPH();
+    template<typename Fn>
+    void forEachNeighbour(size_t i, Fn fn) const;
+};
@@ -3,60 +3,128 @@
 #include <vector>
 #include <algorithm>
 #include "Forces.hpp" 
+#include "BodyStore.hpp"
+#include "Recorder.hpp"
 
+// Lightweight view of one body in a BodyStore. Holds only the store and a
+// handle, so it is cheap to create and copy; all state lives in the store.
+// Every setter that changes the simulation is reported to the store's
+// recorder, if any.
 class PhysicsObject {
 public:
-    enum class shapetype { CIRCLE, POLYGON };
+    using shapetype = BodyShape;
 
-    float radius;
-    sf::Vector2f velocity;
-    sf::Vector2f acceleration;
-    sf::Color color;
-    std::vector<sf::Vector2f> vertices;
-    shapetype type;
-    float density;
-    float mass;
-    float area;
-    sf::Vector2f com;
+    PhysicsObject(BodyStore& store, BodyHandle handle) : store(&store), handle(handle) {}
+    virtual ~PhysicsObject() = default;
 
-    std::vector<Forces*> forces; 
+    BodyHandle getHandle() const { return handle; }
+    bool isValid() const { return store->contains(handle); }
 
-    PhysicsObject(std::vector<sf::Vector2f> vertices, sf::Vector2f velocity, sf::Vector2f acceleration, sf::Color color, float density)
-      : vertices(vertices), velocity(velocity), acceleration(acceleration),
-        color(color), density(density), mass(0.0f), area(0.0f), com({0, 0}) {
-        type = (vertices.size() == 1) ? shapetype::CIRCLE : shapetype::POLYGON;
+    shapetype getType() const { return store->shape[index()]; }
+    // Set through PhysicsWorld::setBodyType.
+    BodyType getBodyType() const { return store->type[index()]; }
+    float getMass() const { return store->mass[index()]; }
+    float getDensity() const { return store->density[index()]; }
+    float getArea() const { return store->shapes[index()]->area; }
+    // Shared with every body of the same geometry; see BodyStore::intern.
+    const ShapeRef& getShape() const { return store->shapes[index()]; }
+    sf::Color getColor() const { return store->colors[index()]; }
+    void setColor(sf::Color color) { store->colors[index()] = color; }
+    const AABB& getAABB() const { return store->aabbs[index()]; }
+
+    sf::Vector2f getCOM() const { return store->position(index()); }
+    void setCOM(const sf::Vector2f& com) {
+        if (store->recorder) store->recorder->recordBodyPosition(handle, com);
+        size_t i = index();
+        store->translate(i, com - store->position(i));
+        store->wake(i);
+        if (store->type[i] == BodyType::STATIC) store->staticsChanged();
+    }
+    sf::Vector2f getInterpolatedCOM(float alpha) const {
+        size_t i = index();
+        sf::Vector2f previous = store->previousPosition(i);
+        return previous + (store->position(i) - previous) * alpha;
     }
 
-    PhysicsObject(std::vector<sf::Vector2f> vertices, float radius, sf::Vector2f velocity, sf::Vector2f acceleration, sf::Color color, float density)
-      : vertices(vertices), radius(radius), velocity(velocity), acceleration(acceleration),
-        color(color), density(density), mass(0.0f), area(0.0f), com({0, 0}) {
-        type = shapetype::CIRCLE;
+    float getAngle() const { return store->angle[index()]; }
+    void setAngle(float angle) {
+        if (store->recorder) store->recorder->recordBodyAngle(handle, angle);
+        size_t i = index();
+        store->angle[i] = angle;
+        store->poseChanged(i);
+        store->wake(i);
+        if (store->type[i] == BodyType::STATIC) store->staticsChanged();
+    }
+    float getInterpolatedAngle(float alpha) const {
+        size_t i = index();
+        return store->prevAngle[i] + (store->angle[i] - store->prevAngle[i]) * alpha;
+    }
+    float getAngularVelocity() const { return store->angularVel[index()]; }
+    // Ignored for static bodies; this is how kinematic ones are driven.
+    void setAngularVelocity(float angularVelocity) {
+        if (store->recorder) store->recorder->recordBodyAngularVelocity(handle, angularVelocity);
+        size_t i = index();
+        if (store->type[i] == BodyType::STATIC) return;
+        store->angularVel[i] = angularVelocity;
+        store->wake(i);
+    }
+    float getInertia() const { return store->inertia[index()]; }
+    // Applied over the next step, then cleared.
+    void applyTorque(float torque) {
+        if (store->recorder) store->recorder->recordTorque(handle, torque);
+        size_t i = index();
+        store->torque[i] += torque;
+        store->wake(i);
     }
 
-    virtual ~PhysicsObject() {
-        for (Forces* f : forces) delete f;
+    sf::Vector2f getVelocity() const { return store->velocity(index()); }
+    void setVelocity(const sf::Vector2f& velocity) {
+        if (store->recorder) store->recorder->recordBodyVelocity(handle, velocity);
+        size_t i = index();
+        if (store->type[i] == BodyType::STATIC) return;
+        store->velX[i] = velocity.x;
+        store->velY[i] = velocity.y;
+        store->wake(i);
+    }
+    sf::Vector2f getAcceleration() const {
+        size_t i = index();
+        return sf::Vector2f(store->accX[i], store->accY[i]);
     }
 
-    virtual void update(float dt, float window_width, float window_height) = 0;
-    virtual void draw(sf::RenderWindow& window) = 0;
-    virtual float computeArea() = 0;
-    virtual void computeMass() = 0;
-    virtual void computeCOM() = 0;
+    bool isAwake() const { return store->awake[index()] != 0; }
 
-    float getMass() const { return mass; }
-    sf::Vector2f getCOM() const { return com; }
+    // Bullets are swept through their motion each step so they can't tunnel
+    // through thin or small bodies. Costs a time-of-impact search per step.
+    void setBullet(bool value) {
+        if (store->recorder) store->recorder->recordBullet(handle, value);
+        store->bullet[index()] = value ? 1 : 0;
+    }
+    bool isBullet() const { return store->bullet[index()] != 0; }
+    void wake() {
+        if (store->recorder) store->recorder->recordWake(handle);
+        store->wake(index());
+    }
+
+    // Forces act on top of the world's gravity until removed or the body goes.
+    void addForce(const ForceDef& force) {
+        if (store->recorder) store->recorder->recordForce(handle, force);
+        store->forces.add(handle.id, force);
+        store->wake(index());
+    }
+    void addForce(std::unique_ptr<Forces> force) {
+        if (store->recorder) store->recorder->recordCustomForce(handle);
+        store->forces.addCustom(handle.id, std::move(force));
+        store->wake(index());
+    }
 
     void removeForcesByType(ForceType type) {
-        forces.erase(
-            std::remove_if(forces.begin(), forces.end(),
-                [type](Forces* force) {
-                    if (force->getType() == type) {
-                        delete force;
-                        return true;
-                    }
-                    return false;
-                }),
-            forces.end()
-        );
+        if (store->recorder) store->recorder->recordRemoveForces(handle, type);
+        store->forces.removeType(handle.id, type);
     }
+
+protected:
+    BodyStore* store;
+    BodyHandle handle;
+
+    size_t index() const { return store->indexOf(handle); }
 };
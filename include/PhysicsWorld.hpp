@@ -0,0 +1,267 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <utility>
+#include "BodyStore.hpp"
+#include "RigidBody.hpp"
+#include "ParticleSystem.hpp"
+#include "CollisionHandler.hpp"
+#include "BroadPhase.hpp"
+#include "NarrowPhase.hpp"
+#include "ContactSolver.hpp"
+#include "IntegrateKernels.hpp"
+#include "StaticBVH.hpp"
+#include "ThreadPool.hpp"
+
+class Recorder;
+
+struct CollisionStats {
+    size_t candidatePairs = 0;
+    size_t contacts = 0;
+    size_t islands = 0;
+    size_t warmStartedPoints = 0;
+    size_t awakeBodies = 0;
+    size_t sleepingBodies = 0;
+    size_t staticBodies = 0;
+    size_t particleCandidates = 0;
+    size_t particleContacts = 0;
+};
+
+// Wall-clock time of each phase of the last step, in milliseconds.
+struct StepTimings {
+    double forces = 0;
+    double broadPhase = 0;
+    double narrowPhase = 0;
+    double solve = 0;
+    double integrate = 0;
+    double particles = 0;
+};
+
+// Owns every body, particle and force and advances the simulation. Has no
+// window or GUI dependency so it can run headless; Environment is just a
+// viewer on top of it.
+class PhysicsWorld {
+public:
+    PhysicsWorld(float width, float height);
+    ~PhysicsWorld();
+
+    PhysicsWorld(const PhysicsWorld&) = delete;
+    PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+    void step(float dt);
+
+    // Runs as many fixed steps as the accumulated frame time allows, capped
+    // at maxSubSteps; leftover time beyond the cap is dropped so a slow frame
+    // can't snowball. Returns the number of steps taken.
+    int advance(float frameTime);
+    float getInterpolationAlpha() const { return accumulator / fixedDt; }
+
+    // Ignores rates that aren't positive and finite.
+    void setStepRate(float stepsPerSecond);
+    float getFixedTimestep() const { return fixedDt; }
+    void setMaxSubSteps(int steps) { maxSubSteps = steps; }
+    int getMaxSubSteps() const { return maxSubSteps; }
+
+    // Gravity acts on every body as a field; per-body forces go through
+    // RigidBody::addForce.
+    BodyHandle createPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density = 7050.0f);
+    BodyHandle createCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density = 7050.0f);
+    void removeBody(BodyHandle handle);
+    void removeLastRigidBody();
+    RigidBody getBody(BodyHandle handle) { return RigidBody(bodies, handle); }
+    // Bodies start dynamic. Static ones never move and are only ever tested
+    // against dynamic ones, through a tree built once per change to the set
+    // of statics, so level geometry costs next to nothing per step.
+    // Kinematic ones move at whatever velocity they are given and push
+    // dynamic bodies without being pushed back; walls don't hold them.
+    void setBodyType(BodyHandle handle, BodyType type);
+    void spawnLiquidObjects(const sf::Vector2f& position, int count);
+    // Removes every body and particle and rewinds the RNG, step count and
+    // contact cache, so a scene rebuilt afterwards replays exactly.
+    void clear();
+
+    void setGravity(const sf::Vector2f& g);
+    sf::Vector2f getGravity() const { return gravity; }
+    // The walls around the world, [0, w] x [0, h] unless set otherwise.
+    // They are independent of any window: a viewer shows part of the world
+    // through its own camera. With walls off nothing holds bodies or
+    // particles in, so a level has to build its own boundary from bodies.
+    void setBounds(float w, float h) { setBounds(sf::FloatRect(0.0f, 0.0f, w, h)); }
+    void setBounds(const sf::FloatRect& rect);
+    const sf::FloatRect& getBounds() const { return bounds; }
+    float getWidth() const { return bounds.width; }
+    float getHeight() const { return bounds.height; }
+    void setWallsEnabled(bool enabled);
+    bool areWallsEnabled() const { return wallsEnabled; }
+
+    // Indices of the bodies whose AABB overlaps box, through the broad phase
+    // and the static tree, sorted. For culling and picking between steps.
+    void queryBodies(const AABB& box, std::vector<size_t>& result);
+
+    // Go through these rather than getParticles() so a Recorder sees them.
+    void setLiquidDensity(float density);
+    void setLiquidModel(LiquidModel model);
+    void setLiquidCapacity(size_t capacity);
+
+    void setBroadPhase(BroadPhaseType type);
+    BroadPhaseType getBroadPhaseType() const { return broadPhase->getType(); }
+    const CollisionStats& getCollisionStats() const { return collisionStats; }
+    const StepTimings& getStepTimings() const { return stepTimings; }
+
+    // Results are identical for every thread count; this only changes speed.
+    void setThreadCount(size_t threads);
+    size_t getThreadCount() const { return pool->size(); }
+
+    // Deterministic mode: step() always advances by the fixed timestep,
+    // whatever dt it is passed, and records a hash of the state after each
+    // step. Given the same seed and the same calls, a build reproduces the
+    // same hashes step for step on any thread count.
+    void setDeterministic(bool enabled);
+    bool isDeterministic() const { return deterministic; }
+    // Seeds the RNG behind spawnLiquidObjects; clear() rewinds it to this seed.
+    void setSeed(std::uint32_t s);
+    std::uint32_t getSeed() const { return seed; }
+    std::uint64_t getStepCount() const { return stepCount; }
+    // State hash after the last step, recorded in deterministic mode only.
+    std::uint64_t getStepHash() const { return stepHash; }
+    // FNV-1a over the bits of every body's and particle's state. Statics
+    // are hashed once per change to them, so this costs the moving bodies.
+    std::uint64_t computeStateHash() const;
+
+    void setSolverIterations(int iterations);
+    int getSolverIterations() const { return solver.getIterations(); }
+    // Start each solve from the impulses the same contact points ended the
+    // last step with. On by default.
+    void setWarmStarting(bool enabled);
+    bool isWarmStarting() const { return solver.isWarmStarting(); }
+
+    // An island goes to sleep once every body in it has stayed below
+    // sleepVelocity for timeToSleep seconds. Sleeping bodies are not
+    // integrated and pairs of sleeping bodies are not tested; they wake on
+    // contact with an awake body, on addForce/setVelocity, or on setGravity.
+    void setSleepingEnabled(bool enabled);
+    bool isSleepingEnabled() const { return sleepingEnabled; }
+    void setSleepThresholds(float velocity, float time);
+
+    // Bodies flagged as bullets (PhysicsObject::setBullet) are swept through
+    // their motion and stopped at the first impact, with up to four impacts
+    // per step. Other bodies move discretely either way.
+    void setContinuousCollision(bool enabled);
+    bool isContinuousCollisionEnabled() const { return continuousCollision; }
+
+    // Semi-implicit Euler by default. Velocity Verlet is second order for
+    // position-dependent forces such as springs, at the cost of evaluating
+    // the forces twice per step.
+    void setIntegrationScheme(IntegrationScheme scheme);
+    IntegrationScheme getIntegrationScheme() const { return integrationScheme; }
+
+    // Set by Recorder::start/stop. Every call above that changes the world
+    // from outside is reported to it, as are the setters on its bodies.
+    void setRecorder(Recorder* r);
+    Recorder* getRecorder() const { return recorder; }
+
+    BodyStore& getBodies() { return bodies; }
+    const BodyStore& getBodies() const { return bodies; }
+    ParticleSystem& getParticles() { return particles; }
+    const ParticleSystem& getParticles() const { return particles; }
+
+private:
+    friend class Snapshot;   // reads and rebuilds the private state
+
+    sf::FloatRect bounds;
+    bool wallsEnabled = true;
+    sf::Vector2f gravity;
+
+    float fixedDt = 1.0f / 120.0f;
+    int maxSubSteps = 8;
+    float accumulator = 0.0f;
+
+    Recorder* recorder = nullptr;
+
+    bool deterministic = false;
+    std::uint32_t seed = 5489u;
+    std::mt19937 rng{5489u};
+    std::uint64_t stepCount = 0;
+    std::uint64_t stepHash = 0;
+
+    bool sleepingEnabled = true;
+    float sleepVelocity = 15.0f;
+    float timeToSleep = 0.5f;
+    std::vector<float> islandSleepTime;
+    std::vector<std::uint32_t> groupsToWake;
+
+    IntegrationScheme integrationScheme = IntegrationScheme::SEMI_IMPLICIT_EULER;
+    std::vector<std::uint8_t> moveMask;     // bodies integrateBodies moves this step
+    std::vector<std::uint8_t> circleMask;   // the circles among them
+
+    bool continuousCollision = true;
+    std::vector<size_t> bulletIndices;
+    std::vector<sf::Vector2f> sweepScratch;
+
+    BodyStore bodies;
+    ParticleSystem particles;
+
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<BroadPhase> broadPhase;
+    bool broadPhaseStale = true;   // bodies were added or removed since the last build
+    // The per-body loops of a step run over movableIndices, the non-static
+    // bodies in dense order, or over movableRanges, the same bodies as runs
+    // of consecutive indices for the kernels. Neither grows with the number
+    // of statics. With statics present the broad phase holds only these
+    // bodies and its indices map to dense ones through the list; without, it
+    // holds every body as is.
+    std::vector<size_t> movableIndices;
+    std::vector<std::pair<size_t, size_t>> movableRanges;   // [begin, end), at most INTEGRATE_GRAIN long
+    bool movableStale = true;
+    std::vector<AABB> movableBoxes;
+    StaticBVH staticTree;
+    std::uint64_t staticTreeRevision = ~std::uint64_t(0);
+    std::vector<std::uint32_t> staticHits;
+    struct StaticScratch {
+        std::vector<BroadPhase::Pair> pairs;
+        std::vector<std::uint32_t> hits;
+    };
+    std::vector<StaticScratch> staticScratch;   // one per pool slot
+    mutable std::uint64_t staticHash = 0;     // computeStateHash's share for the statics
+    mutable std::uint64_t staticHashRevision = ~std::uint64_t(0);
+    std::vector<BroadPhase::Pair> candidatePairs;
+    NarrowPhase narrowPhase;
+    std::vector<CollisionHandler::Contact> contacts;
+    ContactSolver solver;
+    std::vector<size_t> queryResults;
+    CollisionStats collisionStats;
+    StepTimings stepTimings;
+
+    void refreshBodyLists();
+    // fn(begin, end, slot) over movableRanges, spread across the pool.
+    void forMovableRanges(const ThreadPool::RangeFn& fn);
+    void buildBroadPhase();
+    // Dense indices of the bodies overlapping box: queryMovable through the
+    // broad phase, sorted, queryStatics through the static tree, appended.
+    void queryMovable(const AABB& box, std::vector<size_t>& result) const;
+    void queryStatics(const AABB& box, std::vector<size_t>& result, std::vector<std::uint32_t>& hits) const;
+    void findStaticPairs();
+
+    void applyForces();
+    // Velocities are updated before the solver so contacts cancel this step's
+    // gravity instead of last step's; positions move after it.
+    void integrateVelocities(float dt);
+    void integrateBodies(float dt);
+    IntegrateKernels::Bodies bodyArrays(const std::uint8_t* mask);
+    // The walls as the kernels take them; infinitely far with walls off.
+    IntegrateKernels::Bounds wallBounds() const;
+    // The world bounds act as immovable walls with friction: touching bodies
+    // get solver contacts against CollisionHandler::WORLD.
+    void addWallContacts();
+    // Call right after poseChanged(i); moves the body and its AABB together.
+    void clampToBounds(size_t i);
+    void advanceBullet(size_t i, float dt);
+    void resolveImpact(size_t bullet, size_t other, const CollisionHandler::CollisionInfo& info);
+    void wakeTouchedIslands();
+    void wakeContactIslands();
+    void wakeGroups();
+    void updateSleep(float dt);
+};
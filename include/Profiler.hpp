@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped-zone instrumentation. Zones and counters are collected per frame into
+// a fixed ring of frames, which the overlay reads for its histograms and which
+// can be written out as a Chrome trace (chrome://tracing or Perfetto).
+//
+// Build without PHYSICS_PROFILING and the macros below compile to nothing.
+// Zone and counter names must be string literals: only the pointer is kept.
+// Each thread records zones into its own buffer; endFrame() merges them.
+class Profiler {
+public:
+    static constexpr size_t HISTORY = 240;
+    // Zones beyond this in a single frame are dropped, so code that never
+    // calls endFrame() can't grow the buffer without bound.
+    static constexpr size_t MAX_ZONES_PER_FRAME = 16384;
+
+    struct Zone {
+        const char* name;
+        uint32_t thread;
+        int64_t startUs;
+        int64_t endUs;
+    };
+
+    struct Counter {
+        const char* name;
+        double value;
+    };
+
+    struct Frame {
+        int64_t startUs = 0;
+        int64_t endUs = 0;
+        std::vector<Zone> zones;
+        std::vector<Counter> counters;
+    };
+
+    static Profiler& get();
+
+    void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void addZone(const char* name, int64_t startUs, int64_t endUs);
+    // Counters with the same name accumulate within a frame.
+    void addCounter(const char* name, double value);
+    // Closes the current frame, records its allocation count and opens the next.
+    void endFrame();
+
+    // Per completed frame, oldest first.
+    std::vector<float> frameHistory() const;
+    std::vector<float> zoneHistory(const char* name) const;
+    std::vector<float> counterHistory(const char* name) const;
+
+    bool writeChromeTrace(const std::string& path) const;
+
+    int64_t nowUs() const;
+    static uint32_t threadId();
+    // Global operator new calls since startup; always 0 when profiling is compiled out.
+    static uint64_t allocationCount();
+
+private:
+    // One per recording thread. Its mutex is only contended while endFrame()
+    // drains it.
+    struct ThreadZones {
+        std::mutex mutex;
+        std::vector<Zone> zones;
+    };
+
+    Profiler();
+    ThreadZones& threadZones();
+
+    template <typename Fn>
+    std::vector<float> history(Fn valueOf) const;
+
+    std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex;
+    std::vector<Frame> frames;
+    // Guarded by mutex. A buffer stays registered after its thread exits so
+    // its last zones still get merged; endFrame() drops it then.
+    std::vector<std::shared_ptr<ThreadZones>> threadBuffers;
+    size_t current = 0;
+    size_t completed = 0;
+    uint64_t frameAllocStart = 0;
+    std::atomic<bool> enabled{true};
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name), startUs(Profiler::get().isEnabled() ? Profiler::get().nowUs() : -1) {}
+
+    ~ProfileZone() {
+        if (startUs >= 0) {
+            Profiler::get().addZone(name, startUs, Profiler::get().nowUs());
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    int64_t startUs;
+};
+
+#ifdef PHYSICS_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::get().addCounter(name, static_cast<double>(value))
+#define PROFILE_FRAME() Profiler::get().endFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+// Rolling per-frame histograms of the profiler's zones and counters, drawn as
+// one vertex array of bars plus a label per row.
+class ProfilerOverlay {
+public:
+    ProfilerOverlay(const sf::Font& font);
+
+    void setPosition(const sf::Vector2f& position);
+    void toggle() { visible = !visible; }
+    void setVisible(bool value) { visible = value; }
+    bool isVisible() const { return visible; }
+
+    // Pulls the latest history from the profiler; does nothing while hidden.
+    void update();
+    void draw(sf::RenderWindow& window);
+
+private:
+    struct Series {
+        std::string label;
+        // Exactly one of zone/counter is set; both null means frame time.
+        const char* zone;
+        const char* counter;
+        sf::Color color;
+        sf::Text text;
+    };
+
+    void addSeries(const std::string& label, const char* zone, const char* counter, sf::Color color);
+
+    const sf::Font& font;
+    sf::Vector2f position;
+    bool visible = false;
+
+    std::vector<Series> series;
+    sf::RectangleShape background;
+    sf::VertexArray bars;
+
+    static constexpr float WIDTH = 250.0f;
+    static constexpr float ROW_HEIGHT = 38.0f;
+    static constexpr float BAR_HEIGHT = 20.0f;
+};
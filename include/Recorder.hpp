@@ -0,0 +1,232 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BodyStore.hpp"
+#include "BroadPhase.hpp"
+#include "Forces.hpp"
+#include "IntegrateKernels.hpp"
+#include "ParticleSystem.hpp"
+
+class PhysicsWorld;
+
+// Records everything that changes a world from outside -- body creation,
+// removal and type changes, calls on a body through PhysicsObject, liquid
+// spawns, world and liquid settings, clears -- each tagged
+// with the step it happened before, plus a snapshot keyframe every few
+// seconds of simulated time. Replay turns a recording back into the same
+// simulation.
+//
+// The file is append-only: a header, then records of {type, size, step}
+// followed by a payload padded to 8 bytes. Records are buffered during a step
+// and handed to a writer thread once it ends, so the file is at most one step
+// behind and a crash loses nothing earlier. Keyframes are Snapshot bytes
+// prefixed with the world's state hash, which replay checks to catch
+// divergence.
+class Recorder {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    enum class RecordType : std::uint32_t {
+        KEYFRAME = 1,
+        CREATE_POLYGON,
+        CREATE_CIRCLE,
+        REMOVE_BODY,
+        SPAWN_LIQUID,
+        SET_GRAVITY,
+        SET_LIQUID_DENSITY,
+        SET_LIQUID_MODEL,
+        SET_LIQUID_CAPACITY,
+        SET_BROAD_PHASE,
+        SET_BOUNDS,     // width and height only; replaced by SET_WORLD_BOUNDS
+        CLEAR,
+        SETTING,        // application value with no effect on the world
+        END,
+        SET_INTEGRATION_SCHEME,
+        SET_WORLD_BOUNDS,
+        SET_WALLS,
+        SET_BODY_TYPE,
+        SET_BODY_POSITION,
+        SET_BODY_ANGLE,
+        SET_BODY_VELOCITY,
+        SET_BODY_ANGULAR_VELOCITY,
+        APPLY_TORQUE,
+        SET_BULLET,
+        WAKE_BODY,
+        ADD_FORCE,
+        REMOVE_FORCES,
+        SET_SLEEPING,
+        SET_SLEEP_THRESHOLDS,
+        SET_SOLVER_ITERATIONS,
+        SET_WARM_STARTING,
+        SET_CONTINUOUS_COLLISION,
+        SET_STEP_RATE,
+        SET_DETERMINISTIC,
+        SET_SEED
+    };
+
+    struct RecordHeader {
+        RecordType type;
+        std::uint32_t size;    // payload bytes, before padding
+        std::uint64_t step;    // world step count when the record was made
+    };
+
+    struct KeyframeHeader {
+        std::uint64_t stateHash;
+        std::uint32_t loaded;  // the world was replaced here, not just stepped
+        std::uint32_t reserved;
+    };
+
+    // Event payloads, as written.
+    struct PolygonRecord {
+        sf::Vector2f velocity;
+        sf::Color color;
+        float density;
+        std::uint32_t vertexCount;   // followed by the vertices
+        std::uint32_t reserved;
+    };
+
+    struct CircleRecord {
+        sf::Vector2f center;
+        sf::Vector2f velocity;
+        sf::Color color;
+        float radius;
+        float density;
+        std::uint32_t reserved;
+    };
+
+    struct SpawnRecord {
+        sf::Vector2f position;
+        std::int32_t count;
+        std::uint32_t reserved;
+    };
+
+    struct BodyTypeRecord {
+        BodyHandle handle;
+        std::uint32_t type;
+        std::uint32_t reserved;
+    };
+
+    struct BodyVectorRecord {
+        BodyHandle handle;
+        sf::Vector2f value;
+    };
+
+    struct BodyValueRecord {
+        BodyHandle handle;
+        float value;
+        std::uint32_t reserved;
+    };
+
+    struct BodyFlagRecord {
+        BodyHandle handle;
+        std::uint32_t value;
+        std::uint32_t reserved;
+    };
+
+    struct ForceRecord {
+        BodyHandle handle;
+        std::uint32_t type;
+        sf::Vector2f vector;
+        float coefficient;
+        float damping;
+        std::uint32_t reserved;
+    };
+
+    struct SleepThresholdRecord {
+        float velocity;
+        float time;
+    };
+
+    struct SettingRecord {
+        float value;
+        std::uint32_t keyLength;     // followed by the key
+    };
+
+    Recorder() = default;
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Attaches to world and opens path, starting with a keyframe of the
+    // world as it is, so a recording can begin mid-session.
+    bool start(const std::string& path, PhysicsWorld& world);
+    // Writes the end marker, waits for the writer and detaches.
+    void stop();
+    bool isRecording() const { return world != nullptr; }
+
+    // Steps between keyframes; 600 is five seconds at the default rate.
+    void setKeyframeInterval(std::uint64_t steps) { keyframeInterval = steps; }
+    std::uint64_t getKeyframeInterval() const { return keyframeInterval; }
+
+    // Called by PhysicsWorld from the matching API calls.
+    void recordPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density);
+    void recordCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density);
+    void recordRemove(BodyHandle handle);
+    void recordBodyType(BodyHandle handle, BodyType type);
+    // From the PhysicsObject setters, through BodyStore::recorder.
+    void recordBodyPosition(BodyHandle handle, const sf::Vector2f& position);
+    void recordBodyAngle(BodyHandle handle, float angle);
+    void recordBodyVelocity(BodyHandle handle, const sf::Vector2f& velocity);
+    void recordBodyAngularVelocity(BodyHandle handle, float angularVelocity);
+    void recordTorque(BodyHandle handle, float torque);
+    void recordBullet(BodyHandle handle, bool bullet);
+    void recordWake(BodyHandle handle);
+    void recordForce(BodyHandle handle, const ForceDef& force);
+    // Custom forces are code, not data: they can't be recorded, so replay
+    // runs without them. Logs a warning once per recording.
+    void recordCustomForce(BodyHandle handle);
+    void recordRemoveForces(BodyHandle handle, ForceType type);
+    void recordSpawn(const sf::Vector2f& position, int count);
+    void recordGravity(const sf::Vector2f& gravity);
+    void recordLiquidDensity(float density);
+    void recordLiquidModel(LiquidModel model);
+    void recordLiquidCapacity(size_t capacity);
+    void recordBroadPhase(BroadPhaseType type);
+    void recordBounds(const sf::FloatRect& bounds);
+    void recordWalls(bool enabled);
+    void recordIntegrationScheme(IntegrationScheme scheme);
+    void recordSleeping(bool enabled);
+    void recordSleepThresholds(float velocity, float time);
+    void recordSolverIterations(int iterations);
+    void recordWarmStarting(bool enabled);
+    void recordContinuousCollision(bool enabled);
+    void recordStepRate(float stepsPerSecond);
+    void recordDeterministic(bool enabled);
+    void recordSeed(std::uint32_t seed);
+    void recordClear();
+    // Called by PhysicsWorld after every step: flushes the step's records
+    // and adds a keyframe when one is due.
+    void stepEnded();
+
+    // For values outside the world, e.g. the viewer's properties panel.
+    void recordSetting(const std::string& key, float value);
+    // Keyframe now. Pass loaded after replacing the world wholesale (say,
+    // from a snapshot) so replay restores it instead of checking it.
+    void recordKeyframe(bool loaded = false);
+
+private:
+    PhysicsWorld* world = nullptr;
+    std::uint64_t keyframeInterval = 600;
+    std::uint64_t stepsSinceKeyframe = 0;
+    std::vector<char> pending;    // records of the current step
+    bool warnedCustomForce = false;
+
+    std::ofstream file;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::vector<char>> queue;
+    bool stopping = false;
+
+    void record(RecordType type, const void* payload, size_t size);
+    void record(RecordType type, const void* first, size_t firstSize, const void* second, size_t secondSize);
+    void flush();
+    void writeLoop();
+};
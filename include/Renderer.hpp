@@ -0,0 +1,47 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "BodyStore.hpp"
+#include "ParticleSystem.hpp"
+
+// Batched drawing for the body store and the particle pool. Every shape is
+// triangulated into a persistent vertex array that is refilled in place each
+// frame, so a whole batch costs one draw call however many objects it holds.
+// Bodies are untextured triangles. Particles are one quad each, textured
+// with a small disc generated on first use, so a particle costs four
+// vertices whatever its radius; their batch also draws on top of bodies.
+//
+// For a world larger than the screen, pass what is visible: the bodies a
+// broad-phase query over the view returned, and the view box for particles.
+// Only those are triangulated, so drawing costs what is on screen.
+class Renderer {
+public:
+    void drawBodies(sf::RenderWindow& window, const BodyStore& bodies, float alpha = 1.0f);
+    void drawBodies(sf::RenderWindow& window, const BodyStore& bodies, const std::vector<size_t>& visible,
+                    float alpha = 1.0f);
+    void drawParticles(sf::RenderWindow& window, const ParticleSystem& particles, float alpha = 1.0f);
+    void drawParticles(sf::RenderWindow& window, const ParticleSystem& particles, const AABB& view,
+                       float alpha = 1.0f);
+
+    size_t getDrawCalls() const { return drawCalls; }
+    // Call once per frame before drawing to reset the draw-call count.
+    void beginFrame() { drawCalls = 0; }
+
+private:
+    // Unit-circle outline for the segment count that suits radius. Outlines are
+    // built once per bucket and shared by every circle that falls into it.
+    const std::vector<sf::Vector2f>& circleOutline(float radius);
+    void appendCircle(size_t& cursor, const sf::Vector2f& center, float radius, sf::Color color);
+    size_t bodyVertexCount(const BodyStore& bodies, size_t i) const;
+    void appendBody(size_t& cursor, const BodyStore& bodies, size_t i, float alpha);
+    void appendParticle(size_t& cursor, const ParticleSystem& particles, size_t i, float alpha);
+    const sf::Texture& particleSprite();
+
+    sf::VertexArray bodyBatch{sf::Triangles};
+    sf::VertexArray particleBatch{sf::Quads};
+    sf::Texture particleTexture;
+    bool particleTextureReady = false;
+    std::vector<std::vector<sf::Vector2f>> circleCache;
+    std::vector<size_t> visibleParticles;
+    size_t drawCalls = 0;
+};
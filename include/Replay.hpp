@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Recorder.hpp"
+
+class PhysicsWorld;
+
+// Plays a Recorder file back into a world, headless and as fast as the world
+// steps. Records are applied before the step they were tagged with, so the
+// world goes through the same calls in the same order as when it was
+// recorded. A periodic keyframe met on the way is compared against the
+// world's state hash; on a mismatch the divergence is counted and the world
+// is resynchronised from the keyframe.
+//
+// A recording cut short by a crash replays up to its last complete record.
+class Replay {
+public:
+    // Reads the whole recording into memory and indexes its records.
+    bool open(const std::string& path);
+
+    size_t getKeyframeCount() const { return keyframes.size(); }
+    std::uint64_t getKeyframeStep(size_t keyframe) const { return records[keyframes[keyframe]].step; }
+    // Restores world from the keyframe and continues from there. Keyframe 0
+    // is the start of the recording.
+    bool seek(PhysicsWorld& world, size_t keyframe);
+    // Applies records and steps world until the recording ends or maxSteps
+    // steps have run. Returns the number of steps taken.
+    std::uint64_t run(PhysicsWorld& world, std::uint64_t maxSteps = UINT64_MAX);
+    bool isFinished() const { return cursor >= records.size(); }
+
+    std::uint64_t getVerifiedKeyframes() const { return verifiedKeyframes; }
+    std::uint64_t getDivergences() const { return divergences; }
+    // Latest value of each application setting (Recorder::recordSetting) seen so far.
+    const std::map<std::string, float>& getSettings() const { return settings; }
+
+private:
+    struct Entry {
+        Recorder::RecordType type;
+        std::uint64_t step;
+        const char* payload;
+        size_t size;
+    };
+
+    std::vector<char> bytes;
+    std::vector<Entry> records;
+    std::vector<size_t> keyframes;   // indices into records
+    size_t cursor = 0;
+    std::uint64_t verifiedKeyframes = 0;
+    std::uint64_t divergences = 0;
+    std::map<std::string, float> settings;
+
+    bool apply(PhysicsWorld& world, const Entry& entry);
+    bool restoreKeyframe(PhysicsWorld& world, const Entry& entry);
+};
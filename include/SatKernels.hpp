@@ -0,0 +1,56 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+
+// Projection kernels for the separating axis test. Each call projects every
+// vertex of a polygon onto a batch of axes and writes the smallest and
+// largest projection per axis. Axes are passed as separate x and y arrays so
+// the vector kernels can load several at once. All four arrays must hold
+// MAX_AXES floats: the vector kernels work in whole lanes and may read and
+// write entries past axisCount, whose results are meaningless.
+//
+// The vector kernels compute each dot product as x*ax + y*ay with a separate
+// multiply and add, so they give bit-identical results to the scalar one.
+namespace SatKernels {
+
+enum class Kernel { Scalar, Sse, Avx2 };
+
+// Axes handled per kernel call; callers batch at most this many. A whole
+// number of AVX lanes.
+constexpr size_t MAX_AXES = 16;
+
+void projectScalar(const sf::Vector2f* vertices, size_t vertexCount,
+                   const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs);
+#if defined(__SSE2__) || defined(_M_X64)
+#define PHYSICS_SAT_SSE 1
+void projectSse(const sf::Vector2f* vertices, size_t vertexCount,
+                const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs);
+#endif
+#if defined(PHYSICS_AVX2)
+// Built in its own source with AVX2 enabled; only call it when
+// available(Kernel::Avx2).
+void projectAvx2(const sf::Vector2f* vertices, size_t vertexCount,
+                 const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs);
+#endif
+
+// The widest kernel both this build and the CPU running it support, chosen
+// once. AVX2 kernels are only built with PHYSICS_AVX2.
+Kernel best();
+const char* name(Kernel kernel);
+bool available(Kernel kernel);
+
+// Dispatches to the given kernel, falling back to scalar if unavailable.
+void project(Kernel kernel, const sf::Vector2f* vertices, size_t vertexCount,
+             const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs);
+
+using ProjectFn = void (*)(const sf::Vector2f* vertices, size_t vertexCount,
+                           const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs);
+// The kernel best() names, resolved at startup.
+extern const ProjectFn bestProject;
+
+inline void project(const sf::Vector2f* vertices, size_t vertexCount,
+                    const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs) {
+    bestProject(vertices, vertexCount, axisX, axisY, axisCount, mins, maxs);
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <vector>
+
+struct AABB {
+    sf::Vector2f min;
+    sf::Vector2f max;
+
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y;
+    }
+};
+
+enum class BodyShape {
+    CIRCLE,
+    POLYGON
+};
+
+// Geometry of a shape in its own frame, centroid at the origin. Immutable
+// once built and shared by every body made from it, so a pile of identical
+// boxes holds one copy of the local vertices and normals. Each polygon body
+// still keeps its own world-space vertices in BodyStore's vertex cache.
+struct ShapeDef {
+    BodyShape type = BodyShape::POLYGON;
+    float radius = 0.0f;                  // circles only
+    std::vector<sf::Vector2f> vertices;   // polygons, relative to the centroid
+    std::vector<sf::Vector2f> normals;    // outward unit normal of the edge vertices[k] -> vertices[k + 1]
+    sf::Vector2f centroid;                // in the coordinates the polygon was given in
+    float area = 0.0f;
+    float unitInertia = 0.0f;             // about the centroid at density 1
+    AABB bounds;                          // of the local vertices
+    float boundingRadius = 0.0f;
+
+    static ShapeDef polygon(const std::vector<sf::Vector2f>& worldVertices);
+    static ShapeDef circle(float radius);
+};
+
+using ShapeRef = std::shared_ptr<const ShapeDef>;
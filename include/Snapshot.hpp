@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+#include "PhysicsWorld.hpp"
+
+// Binary snapshot of a world: bodies, shapes, forces, particles and settings,
+// plus the hidden state a deterministic run depends on (RNG, step count,
+// contact cache), so a run continued from a loaded snapshot produces the same
+// step hashes as one that never stopped. Applications can store their own
+// named values alongside, e.g. the viewer's properties panel.
+//
+// A file is a short header followed by tagged sections. Per-body and
+// per-particle data is written as the SoA arrays themselves in native byte
+// order, each padded to 8 bytes, so loading maps the file and copies every
+// array straight out of the mapping without parsing it element by element.
+// Readers skip sections they don't recognise, migrate files from an older
+// version and refuse ones from a newer version or with the other byte order.
+class Snapshot {
+public:
+    // 2: per-body forces in FARN instead of per-body gravity copies in FORC.
+    // 3: the bounds' origin in BNDS.
+    // 4: body types in TYPE.
+    static constexpr std::uint32_t VERSION = 4;
+    using Settings = std::map<std::string, float>;
+
+    Snapshot() = default;
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    // Serialises the world into memory. This is the only part of saving that
+    // reads the world, so only it has to stay clear of step().
+    static std::vector<char> capture(const PhysicsWorld& world, const Settings& settings = Settings());
+    // Writes to a temporary file and renames it over path, so an interrupted
+    // save never leaves a truncated snapshot behind.
+    static bool write(const std::string& path, const std::vector<char>& bytes);
+    // capture() on this thread, write() on a background one. The future
+    // holds whether the write succeeded; destroying it waits for the write.
+    static std::future<bool> saveAsync(const PhysicsWorld& world, const std::string& path,
+                                       const Settings& settings = Settings());
+
+    // Maps the file read-only (reads it into memory on Windows) and checks
+    // the header and section table. Returns false, logging why, if it is not
+    // a snapshot this build can read.
+    bool open(const std::string& path);
+    // Same, for bytes returned by capture().
+    bool open(std::vector<char> bytes);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    const Settings& getSettings() const { return settings; }
+    // Replaces everything in world with the snapshot's contents. Handles
+    // that were valid when the snapshot was captured are valid again. On
+    // failure the world is left untouched.
+    bool restore(PhysicsWorld& world) const;
+
+private:
+    struct Section {
+        std::uint32_t tag;
+        std::uint32_t count;
+        const char* payload;
+        size_t size;
+    };
+
+    const char* data = nullptr;
+    size_t size = 0;
+    void* mapped = nullptr;    // set when data points into an mmap
+    std::vector<char> buffer;  // otherwise data points here
+    std::vector<Section> sections;
+    Settings settings;
+    std::uint32_t version = 0;   // of the open file
+
+    bool parse();
+    const Section* findSection(std::uint32_t tag) const;
+};
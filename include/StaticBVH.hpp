@@ -0,0 +1,45 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include "BodyStore.hpp"
+
+// Bounding volume hierarchy over the static bodies. Static geometry never
+// moves during a step, so the tree is built once, whenever the set of
+// statics changes (BodyStore::getStaticRevision), and only read after that.
+// Leaves name bodies by id rather than dense index, so creating and removing
+// other bodies leaves the tree valid.
+class StaticBVH {
+public:
+    void build(const BodyStore& bodies);
+    void clear();
+
+    size_t size() const { return ids.size(); }
+    // Ids of the statics whose AABB overlaps box. The order is fixed by the
+    // tree, so the same query always lists them the same way. Safe to call
+    // from several threads at once.
+    void query(const AABB& box, std::vector<std::uint32_t>& result) const;
+
+private:
+    // An inner node's children are nodes first and second; a leaf holds
+    // items [first, first + count).
+    struct Node {
+        AABB box;
+        std::uint32_t first;
+        std::uint32_t second;
+        std::uint32_t count;    // 0 for inner nodes
+    };
+
+    struct Item {
+        AABB box;
+        sf::Vector2f center;
+        std::uint32_t id;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<AABB> boxes;             // item boxes in leaf order
+    std::vector<std::uint32_t> ids;      // likewise
+    std::vector<Item> items;             // build scratch
+
+    std::uint32_t buildRange(std::uint32_t begin, std::uint32_t end);
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Each thread owns a task deque: it pops from the back of
+// its own and steals from the front of the others when it runs dry. The
+// thread calling parallelFor takes part as slot 0, so a pool of size 1 runs
+// everything inline.
+class ThreadPool {
+public:
+    // fn(begin, end, slot): slot is in [0, size()) and identifies the thread,
+    // so callers can keep one scratch buffer per slot without locking.
+    using RangeFn = std::function<void(size_t, size_t, size_t)>;
+
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return queues.size(); }
+
+    // Splits [0, count) into grain-sized tasks and blocks until all have run.
+    void parallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+private:
+    struct Task {
+        size_t begin;
+        size_t end;
+        const RangeFn* fn;
+        std::atomic<size_t>* remaining;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{0};
+    bool stopping = false;
+
+    bool runOne(size_t slot);
+    void workerLoop(size_t slot);
+};
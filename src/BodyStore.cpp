@@ -0,0 +1,276 @@
+#include "BodyStore.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+template<typename T>
+void eraseAt(std::vector<T>& v, size_t i) {
+    v.erase(v.begin() + i);
+}
+
+}
+
+BodyStore::~BodyStore() {
+    clear();
+}
+
+BodyHandle BodyStore::createPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density) {
+    ShapeDef def = ShapeDef::polygon(vertices);
+    sf::Vector2f centroid = def.centroid;
+    return create(intern(std::move(def)), centroid, 0.0f, velocity, color, density);
+}
+
+BodyHandle BodyStore::createCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density) {
+    return create(intern(ShapeDef::circle(radius)), center, 0.0f, velocity, color, density);
+}
+
+std::vector<float> BodyStore::shapeKey(const ShapeDef& def) {
+    // Snap to 1/1024 px: the same box placed at two positions comes out a
+    // few ulps apart after the centroid is subtracted, and should still match.
+    auto snap = [](float value) { return std::round(value * 1024.0f); };
+    std::vector<float> key;
+    key.reserve(2 + 2 * def.vertices.size());
+    key.push_back(static_cast<float>(def.type));
+    key.push_back(snap(def.radius));
+    for (const sf::Vector2f& v : def.vertices) {
+        key.push_back(snap(v.x));
+        key.push_back(snap(v.y));
+    }
+    return key;
+}
+
+ShapeRef BodyStore::intern(ShapeDef def) {
+    std::weak_ptr<const ShapeDef>& entry = shapeCache[shapeKey(def)];
+    ShapeRef existing = entry.lock();
+    if (existing) {
+        return existing;
+    }
+    ShapeRef created = std::make_shared<const ShapeDef>(std::move(def));
+    entry = created;
+    return created;
+}
+
+BodyHandle BodyStore::create(const ShapeRef& shapeDef, const sf::Vector2f& com, float startAngle,
+                             sf::Vector2f velocity, sf::Color color, float d) {
+    std::uint32_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = static_cast<std::uint32_t>(idToIndex.size());
+        idToIndex.push_back(0);
+        generations.push_back(0);
+    }
+
+    size_t index = size();
+    idToIndex[id] = static_cast<std::uint32_t>(index);
+    indexToId.push_back(id);
+
+    float m = d * shapeDef->area;
+    float momentOfInertia = d * shapeDef->unitInertia;
+    posX.push_back(com.x);
+    posY.push_back(com.y);
+    prevX.push_back(com.x);
+    prevY.push_back(com.y);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+    accX.push_back(0.0f);
+    accY.push_back(0.0f);
+    angle.push_back(startAngle);
+    prevAngle.push_back(startAngle);
+    angularVel.push_back(0.0f);
+    torque.push_back(0.0f);
+    mass.push_back(m);
+    invMass.push_back(m > 0 ? 1.0f / m : 0.0f);
+    inertia.push_back(momentOfInertia);
+    invInertia.push_back(momentOfInertia > 0 ? 1.0f / momentOfInertia : 0.0f);
+    shapes.push_back(shapeDef);
+    shape.push_back(shapeDef->type);
+    radius.push_back(shapeDef->radius);
+    density.push_back(d);
+    vertexOffset.push_back(static_cast<std::uint32_t>(vertexPool.size()));
+    vertexPool.resize(vertexPool.size() + shapeDef->vertices.size());
+    verticesStale.push_back(1);
+    aabbs.push_back(AABB());
+    colors.push_back(color);
+    awake.push_back(1);
+    sleepTime.push_back(0.0f);
+    sleepGroup.push_back(0);
+    bullet.push_back(0);
+    type.push_back(BodyType::DYNAMIC);
+
+    updateAABB(index);
+
+    BodyHandle handle;
+    handle.id = id;
+    handle.generation = generations[id];
+    return handle;
+}
+
+void BodyStore::destroy(BodyHandle handle) {
+    if (!contains(handle)) {
+        return;
+    }
+
+    // Erase in place rather than swap-and-pop so dense order keeps matching
+    // creation order; removal is rare compared to iteration.
+    size_t i = indexOf(handle);
+    std::uint32_t first = vertexOffset[i];
+    std::uint32_t count = static_cast<std::uint32_t>(vertexCount(i));
+    vertexPool.erase(vertexPool.begin() + first, vertexPool.begin() + first + count);
+    for (size_t j = i + 1; j < size(); j++) {
+        vertexOffset[j] -= count;
+    }
+
+    // The cache only holds weak references, so this body being the last
+    // owner means the shape is about to go. Shapes made elsewhere (a
+    // snapshot, say) can share a key without being the cached definition,
+    // so only drop an entry that is this definition or already dead.
+    if (shapes[i].use_count() == 1) {
+        auto entry = shapeCache.find(shapeKey(*shapes[i]));
+        if (entry != shapeCache.end()) {
+            std::shared_ptr<const ShapeDef> cached = entry->second.lock();
+            if (!cached || cached == shapes[i]) {
+                shapeCache.erase(entry);
+            }
+        }
+    }
+
+    forces.removeBody(handle.id);
+    if (type[i] == BodyType::STATIC) {
+        staticsChanged();
+    }
+
+    eraseAt(posX, i);
+    eraseAt(posY, i);
+    eraseAt(prevX, i);
+    eraseAt(prevY, i);
+    eraseAt(velX, i);
+    eraseAt(velY, i);
+    eraseAt(accX, i);
+    eraseAt(accY, i);
+    eraseAt(angle, i);
+    eraseAt(prevAngle, i);
+    eraseAt(angularVel, i);
+    eraseAt(torque, i);
+    eraseAt(mass, i);
+    eraseAt(invMass, i);
+    eraseAt(inertia, i);
+    eraseAt(invInertia, i);
+    eraseAt(shapes, i);
+    eraseAt(shape, i);
+    eraseAt(radius, i);
+    eraseAt(density, i);
+    eraseAt(vertexOffset, i);
+    eraseAt(verticesStale, i);
+    eraseAt(aabbs, i);
+    eraseAt(colors, i);
+    eraseAt(awake, i);
+    eraseAt(sleepTime, i);
+    eraseAt(sleepGroup, i);
+    eraseAt(bullet, i);
+    eraseAt(type, i);
+    eraseAt(indexToId, i);
+
+    for (size_t j = i; j < indexToId.size(); j++) {
+        idToIndex[indexToId[j]] = static_cast<std::uint32_t>(j);
+    }
+
+    generations[handle.id]++;
+    freeIds.push_back(handle.id);
+}
+
+void BodyStore::clear() {
+    forces.clear();
+    while (size() > 0) {
+        destroy(handleAt(size() - 1));
+    }
+}
+
+bool BodyStore::contains(BodyHandle handle) const {
+    // destroy() bumps the generation, so stale handles never match.
+    return handle.id < generations.size() && generations[handle.id] == handle.generation;
+}
+
+BodyHandle BodyStore::handleAt(size_t index) const {
+    BodyHandle handle;
+    handle.id = indexToId[index];
+    handle.generation = generations[handle.id];
+    return handle;
+}
+
+void BodyStore::wakeAll() {
+    for (size_t i = 0; i < size(); i++) {
+        wake(i);
+    }
+}
+
+void BodyStore::setType(size_t i, BodyType bodyType) {
+    if (type[i] == BodyType::STATIC || bodyType == BodyType::STATIC) {
+        staticsChanged();
+    }
+    type[i] = bodyType;
+
+    if (bodyType == BodyType::DYNAMIC) {
+        const ShapeDef& def = *shapes[i];
+        mass[i] = density[i] * def.area;
+        invMass[i] = mass[i] > 0 ? 1.0f / mass[i] : 0.0f;
+        inertia[i] = density[i] * def.unitInertia;
+        invInertia[i] = inertia[i] > 0 ? 1.0f / inertia[i] : 0.0f;
+        wake(i);
+        return;
+    }
+
+    mass[i] = invMass[i] = 0.0f;
+    inertia[i] = invInertia[i] = 0.0f;
+    accX[i] = accY[i] = 0.0f;
+    torque[i] = 0.0f;
+    sleepTime[i] = 0.0f;
+    if (bodyType == BodyType::STATIC) {
+        velX[i] = velY[i] = 0.0f;
+        angularVel[i] = 0.0f;
+        awake[i] = 0;
+    } else {
+        awake[i] = 1;
+    }
+}
+
+void BodyStore::transformVertices(size_t i) {
+    float c = std::cos(angle[i]);
+    float s = std::sin(angle[i]);
+    const sf::Vector2f* local = localVertices(i);
+    sf::Vector2f* world = vertexPool.data() + vertexOffset[i];
+    for (size_t k = 0; k < vertexCount(i); k++) {
+        world[k] = sf::Vector2f(posX[i] + c * local[k].x - s * local[k].y,
+                                posY[i] + s * local[k].x + c * local[k].y);
+    }
+    verticesStale[i] = 0;
+}
+
+void BodyStore::updateAABB(size_t i) {
+    AABB& box = aabbs[i];
+    if (shape[i] == BodyShape::CIRCLE) {
+        box.min = sf::Vector2f(posX[i] - radius[i], posY[i] - radius[i]);
+        box.max = sf::Vector2f(posX[i] + radius[i], posY[i] + radius[i]);
+        return;
+    }
+
+    // Box around the rotated local bounds, trimmed to the bounding circle.
+    // Needs no world vertices; exact for unrotated shapes and for boxes.
+    const ShapeDef& def = *shapes[i];
+    float c = std::cos(angle[i]);
+    float s = std::sin(angle[i]);
+    sf::Vector2f localCenter = (def.bounds.min + def.bounds.max) * 0.5f;
+    sf::Vector2f localHalf = (def.bounds.max - def.bounds.min) * 0.5f;
+    sf::Vector2f center(posX[i] + c * localCenter.x - s * localCenter.y,
+                        posY[i] + s * localCenter.x + c * localCenter.y);
+    float halfX = std::abs(c) * localHalf.x + std::abs(s) * localHalf.y;
+    float halfY = std::abs(s) * localHalf.x + std::abs(c) * localHalf.y;
+
+    float r = def.boundingRadius;
+    box.min.x = std::max(center.x - halfX, posX[i] - r);
+    box.min.y = std::max(center.y - halfY, posY[i] - r);
+    box.max.x = std::min(center.x + halfX, posX[i] + r);
+    box.max.y = std::min(center.y + halfY, posY[i] + r);
+}
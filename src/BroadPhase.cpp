@@ -0,0 +1,145 @@
+#include "BroadPhase.hpp"
+#include <algorithm>
+#include <cmath>
+
+void SweepAndPrune::build(const std::vector<AABB>& bodies) {
+    boxes = bodies;
+    maxWidth = 0.0f;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        maxWidth = std::max(maxWidth, boxes[i].max.x - boxes[i].min.x);
+    }
+
+    // Bodies barely move between frames, so the previous order is almost
+    // sorted and insertion sort runs close to linear time.
+    if (order.size() != boxes.size()) {
+        order.resize(boxes.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+    }
+
+    for (size_t i = 1; i < order.size(); i++) {
+        size_t idx = order[i];
+        float key = boxes[idx].min.x;
+        size_t j = i;
+        while (j > 0 && boxes[order[j - 1]].min.x > key) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = idx;
+    }
+}
+
+void SweepAndPrune::findPairs(std::vector<Pair>& pairs) const {
+    pairs.clear();
+    for (size_t i = 0; i < order.size(); i++) {
+        const AABB& a = boxes[order[i]];
+        for (size_t j = i + 1; j < order.size(); j++) {
+            const AABB& b = boxes[order[j]];
+            if (b.min.x > a.max.x) {
+                break;
+            }
+            if (a.overlaps(b)) {
+                pairs.emplace_back(std::min(order[i], order[j]), std::max(order[i], order[j]));
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
+
+void SweepAndPrune::query(const AABB& box, std::vector<size_t>& result) const {
+    result.clear();
+    // Nothing starting before box.min.x - maxWidth can reach the box.
+    auto first = std::lower_bound(order.begin(), order.end(), box.min.x - maxWidth,
+        [this](size_t idx, float value) { return boxes[idx].min.x < value; });
+
+    for (auto it = first; it != order.end(); ++it) {
+        const AABB& b = boxes[*it];
+        if (b.min.x > box.max.x) {
+            break;
+        }
+        if (b.overlaps(box)) {
+            result.push_back(*it);
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+SpatialHash::SpatialHash(float cellSize) : cellSize(cellSize) {}
+
+std::int64_t SpatialHash::cellKey(int cx, int cy) const {
+    // Packed unsigned; shifting a negative signed coordinate is undefined.
+    return static_cast<std::int64_t>((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+                                     static_cast<std::uint32_t>(cy));
+}
+
+// Kept well inside int range: with the walls off a body can be anywhere.
+int SpatialHash::cellCoord(float v) const {
+    return static_cast<int>(std::min(1e8f, std::max(-1e8f, std::floor(v / cellSize))));
+}
+
+void SpatialHash::build(const std::vector<AABB>& bodies) {
+    boxes = bodies;
+    entries.clear();
+    for (size_t i = 0; i < boxes.size(); i++) {
+        int x0 = cellCoord(boxes[i].min.x), x1 = cellCoord(boxes[i].max.x);
+        int y0 = cellCoord(boxes[i].min.y), y1 = cellCoord(boxes[i].max.y);
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int cy = y0; cy <= y1; cy++) {
+                entries.push_back({cellKey(cx, cy), i});
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+}
+
+void SpatialHash::findPairs(std::vector<Pair>& pairs) const {
+    pairs.clear();
+    for (size_t first = 0; first < entries.size();) {
+        std::int64_t cell = entries[first].cell;
+        size_t last = first + 1;
+        while (last < entries.size() && entries[last].cell == cell) {
+            last++;
+        }
+
+        for (size_t i = first; i < last; i++) {
+            for (size_t j = i + 1; j < last; j++) {
+                const AABB& a = boxes[entries[i].body];
+                const AABB& b = boxes[entries[j].body];
+                if (!a.overlaps(b)) {
+                    continue;
+                }
+                // A pair sharing several cells is only reported by the cell
+                // holding the top-left corner of the overlap region.
+                int cx = cellCoord(std::max(a.min.x, b.min.x));
+                int cy = cellCoord(std::max(a.min.y, b.min.y));
+                if (cellKey(cx, cy) != cell) {
+                    continue;
+                }
+                // Members of a run are sorted, so entries[i].body < entries[j].body.
+                pairs.emplace_back(entries[i].body, entries[j].body);
+            }
+        }
+        first = last;
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
+
+void SpatialHash::query(const AABB& box, std::vector<size_t>& result) const {
+    result.clear();
+    int x0 = cellCoord(box.min.x), x1 = cellCoord(box.max.x);
+    int y0 = cellCoord(box.min.y), y1 = cellCoord(box.max.y);
+    for (int cx = x0; cx <= x1; cx++) {
+        for (int cy = y0; cy <= y1; cy++) {
+            std::int64_t cell = cellKey(cx, cy);
+            auto it = std::lower_bound(entries.begin(), entries.end(), CellEntry{cell, 0});
+            for (; it != entries.end() && it->cell == cell; ++it) {
+                if (boxes[it->body].overlaps(box)) {
+                    result.push_back(it->body);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
@@ -1,4 +1,6 @@
 #include "CollisionHandler.hpp"
+#include "SatKernels.hpp"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
@@ -18,18 +20,48 @@ float dot(const sf::Vector2f& a, const sf::Vector2f& b) {
     return a.x * b.x + a.y * b.y;
 }
 
-CollisionHandler::CollisionInfo CollisionHandler::detectCollision(RigidBody* bodyA, RigidBody* bodyB) {
-    if (bodyA->type == PhysicsObject::shapetype::CIRCLE && bodyB->type == PhysicsObject::shapetype::CIRCLE) {
-        return circleVsCircle(bodyA, bodyB);
+// World-space outward normal of edge k (vertices[k] -> vertices[k + 1]).
+sf::Vector2f edgeNormal(const CollisionHandler::ShapeView& poly, size_t k) {
+    const sf::Vector2f& n = poly.normals[k];
+    return sf::Vector2f(poly.rotation.x * n.x - poly.rotation.y * n.y, poly.rotation.y * n.x + poly.rotation.x * n.y);
+}
+
+CollisionHandler::ShapeView CollisionHandler::bodyShape(const BodyStore& store, size_t index) {
+    ShapeView view;
+    view.type = store.shape[index];
+    view.com = store.position(index);
+    view.radius = store.radius[index];
+    view.vertices = store.vertices(index);
+    view.normals = store.shapes[index]->normals.data();
+    view.rotation = sf::Vector2f(std::cos(store.angle[index]), std::sin(store.angle[index]));
+    view.vertexCount = store.vertexCount(index);
+    return view;
+}
+
+CollisionHandler::ShapeView CollisionHandler::particleShape(const ParticleSystem& particles, size_t index) {
+    ShapeView view;
+    view.type = BodyShape::CIRCLE;
+    view.com = particles.position(index);
+    view.radius = particles.radius[index];
+    view.vertices = nullptr;
+    view.normals = nullptr;
+    view.rotation = sf::Vector2f(1, 0);
+    view.vertexCount = 0;
+    return view;
+}
+
+CollisionHandler::CollisionInfo CollisionHandler::detectCollision(const ShapeView& shapeA, const ShapeView& shapeB) {
+    if (shapeA.type == BodyShape::CIRCLE && shapeB.type == BodyShape::CIRCLE) {
+        return circleVsCircle(shapeA, shapeB);
     }
-    else if (bodyA->type == PhysicsObject::shapetype::POLYGON && bodyB->type == PhysicsObject::shapetype::POLYGON) {
-        return polygonVsPolygon(bodyA, bodyB);
+    else if (shapeA.type == BodyShape::POLYGON && shapeB.type == BodyShape::POLYGON) {
+        return polygonVsPolygon(shapeA, shapeB);
     }
-    else if (bodyA->type == PhysicsObject::shapetype::CIRCLE && bodyB->type == PhysicsObject::shapetype::POLYGON) {
-        return circleVsPolygon(bodyA, bodyB);
+    else if (shapeA.type == BodyShape::CIRCLE && shapeB.type == BodyShape::POLYGON) {
+        return circleVsPolygon(shapeA, shapeB);
     }
-    else if (bodyA->type == PhysicsObject::shapetype::POLYGON && bodyB->type == PhysicsObject::shapetype::CIRCLE) {
-        CollisionInfo info = circleVsPolygon(bodyB, bodyA);
+    else if (shapeA.type == BodyShape::POLYGON && shapeB.type == BodyShape::CIRCLE) {
+        CollisionInfo info = circleVsPolygon(shapeB, shapeA);
         if (info.hasCollision) {
             info.normal = -info.normal;
         }
@@ -39,67 +71,269 @@ CollisionHandler::CollisionInfo CollisionHandler::detectCollision(RigidBody* bod
     return CollisionInfo();
 }
 
-CollisionHandler::CollisionInfo CollisionHandler::circleVsCircle(RigidBody* circleA, RigidBody* circleB) {
+namespace {
+
+CollisionHandler::ShapeView translated(const CollisionHandler::ShapeView& shape, const sf::Vector2f& offset,
+                                       std::vector<sf::Vector2f>& scratch) {
+    CollisionHandler::ShapeView view = shape;
+    view.com += offset;
+    if (shape.type == BodyShape::POLYGON) {
+        scratch.resize(shape.vertexCount);
+        for (size_t k = 0; k < shape.vertexCount; k++) {
+            scratch[k] = shape.vertices[k] + offset;
+        }
+        view.vertices = scratch.data();
+    }
+    return view;
+}
+
+AABB bounds(const CollisionHandler::ShapeView& shape) {
+    if (shape.type == BodyShape::CIRCLE) {
+        sf::Vector2f r(shape.radius, shape.radius);
+        return AABB{shape.com - r, shape.com + r};
+    }
+    AABB box{shape.vertices[0], shape.vertices[0]};
+    for (size_t k = 1; k < shape.vertexCount; k++) {
+        box.min.x = std::min(box.min.x, shape.vertices[k].x);
+        box.min.y = std::min(box.min.y, shape.vertices[k].y);
+        box.max.x = std::max(box.max.x, shape.vertices[k].x);
+        box.max.y = std::max(box.max.y, shape.vertices[k].y);
+    }
+    return box;
+}
+
+// Narrows [enter, exit] to the fractions of motion during which the moving
+// interval [min, max] overlaps [targetMin, targetMax] on one axis.
+bool clipSlab(float min, float max, float motion, float targetMin, float targetMax, float& enter, float& exit) {
+    if (motion == 0.0f) {
+        return min <= targetMax && max >= targetMin;
+    }
+    float t0 = (targetMin - max) / motion;
+    float t1 = (targetMax - min) / motion;
+    if (t0 > t1) std::swap(t0, t1);
+    enter = std::max(enter, t0);
+    exit = std::min(exit, t1);
+    return enter <= exit;
+}
+
+}
+
+float CollisionHandler::minExtent(const ShapeView& shape) {
+    if (shape.type == BodyShape::CIRCLE) {
+        return shape.radius;
+    }
+
+    float extent = std::numeric_limits<float>::max();
+    for (size_t k = 0; k < shape.vertexCount; k++) {
+        extent = std::min(extent, std::abs(dot(shape.com - shape.vertices[k], edgeNormal(shape, k))));
+    }
+    return extent;
+}
+
+bool CollisionHandler::sweep(const ShapeView& moving, const sf::Vector2f& motion, const ShapeView& target,
+                             std::vector<sf::Vector2f>& scratch, float& toi, CollisionInfo& info) {
+    const int bisections = 10;
+    // Distance to stop short of the contact, so rounding in the move to it
+    // can't start the next sweep overlapping, which would skip the target.
+    const float margin = 0.05f;
+
+    if (detectCollision(moving, target).hasCollision) {
+        return false;
+    }
+
+    float distance = vectorLength(motion);
+    if (distance <= 0.0f) {
+        return false;
+    }
+
+    // The shapes can only meet while their bounding boxes overlap, so only
+    // that window of the path needs sampling. Its length is bounded by the
+    // two shapes' size along the motion, not by how far the body travels.
+    AABB from = bounds(moving);
+    AABB box = bounds(target);
+    float enter = 0.0f;
+    float exit = 1.0f;
+    if (!clipSlab(from.min.x, from.max.x, motion.x, box.min.x, box.max.x, enter, exit) ||
+        !clipSlab(from.min.y, from.max.y, motion.y, box.min.y, box.max.y, enter, exit)) {
+        return false;
+    }
+
+    // Half the thinner shape per sample, so a sample can't land past it.
+    float spacing = std::max(0.5f, 0.5f * std::min(minExtent(moving), minExtent(target)));
+    int samples = std::max(1, static_cast<int>(std::ceil(distance * (exit - enter) / spacing)));
+
+    float lo = enter;
+    for (int k = 1; k <= samples; k++) {
+        float hi = enter + (exit - enter) * static_cast<float>(k) / samples;
+        CollisionInfo hit = detectCollision(translated(moving, motion * hi, scratch), target);
+        if (!hit.hasCollision) {
+            lo = hi;
+            continue;
+        }
+
+        for (int b = 0; b < bisections; b++) {
+            float mid = 0.5f * (lo + hi);
+            CollisionInfo midHit = detectCollision(translated(moving, motion * mid, scratch), target);
+            if (midHit.hasCollision) {
+                hi = mid;
+                hit = midHit;
+            } else {
+                lo = mid;
+            }
+        }
+
+        toi = std::max(0.0f, lo - margin / distance);
+        info = hit;
+        return true;
+    }
+    return false;
+}
+
+CollisionHandler::CollisionInfo CollisionHandler::circleVsCircle(const ShapeView& circleA, const ShapeView& circleB) {
     CollisionInfo info;
     
-    sf::Vector2f delta = circleB->com - circleA->com;
+    sf::Vector2f delta = circleB.com - circleA.com;
     float distance = vectorLength(delta);
-    float sumRadii = circleA->radius + circleB->radius;
+    float sumRadii = circleA.radius + circleB.radius;
     
     if (distance < sumRadii) {
         info.hasCollision = true;
         info.normal = normalize(delta);
         info.penetrationDepth = sumRadii - distance;
         
-        info.point = circleA->com + info.normal * circleA->radius;
+        info.point = circleA.com + info.normal * circleA.radius;
+        info.points[0] = info.point;
+        info.depths[0] = info.penetrationDepth;
+        info.pointCount = 1;
     }
     
     return info;
 }
 
-sf::Vector2f getEdge(const std::vector<sf::Vector2f>& vertices, int index) {
-    int nextIndex = (index + 1) % vertices.size();
-    return vertices[nextIndex] - vertices[index];
+namespace {
+
+size_t mostAlignedEdge(const CollisionHandler::ShapeView& poly, const sf::Vector2f& direction) {
+    size_t best = 0;
+    float bestDot = std::numeric_limits<float>::lowest();
+    for (size_t k = 0; k < poly.vertexCount; k++) {
+        float d = dot(edgeNormal(poly, k), direction);
+        if (d > bestDot) {
+            bestDot = d;
+            best = k;
+        }
+    }
+    return best;
 }
 
-CollisionHandler::CollisionInfo CollisionHandler::polygonVsPolygon(RigidBody* polyA, RigidBody* polyB) {
-    CollisionInfo info;
-    float minOverlap = std::numeric_limits<float>::max();
-    sf::Vector2f collisionNormal;
-    
-    for (size_t i = 0; i < polyA->vertices.size(); i++) {
-        sf::Vector2f edge = getEdge(polyA->vertices, i);
-        sf::Vector2f axis(-edge.y, edge.x);
-        axis = normalize(axis);
-        
-        float overlap = 0;
-        if (!checkOverlapOnAxis(axis, polyA->vertices, polyB->vertices, overlap)) {
-            return info;
+// Keeps the part of segment [p0, p1] with dot(p, axis) >= limit. False if
+// nothing is left.
+bool clipSegment(sf::Vector2f& p0, sf::Vector2f& p1, const sf::Vector2f& axis, float limit) {
+    float d0 = dot(p0, axis) - limit;
+    float d1 = dot(p1, axis) - limit;
+    if (d0 < 0 && d1 < 0) return false;
+    if (d0 < 0) p0 = p0 + (p1 - p0) * (d0 / (d0 - d1));
+    else if (d1 < 0) p1 = p0 + (p1 - p0) * (d0 / (d0 - d1));
+    return true;
+}
+
+// Clips the incident edge of one polygon against the side planes of the
+// reference edge of the other and keeps the points that are behind the
+// reference face, or within CONTACT_MARGIN of it: two points for face
+// contact, one for a corner. Each point's feature id packs the reference
+// edge, the incident edge and which end of it the point came from, plus
+// referenceFlag when the reference polygon is the pair's second body.
+void clipPolygonContact(const CollisionHandler::ShapeView& reference, const CollisionHandler::ShapeView& incident,
+                        const sf::Vector2f& referenceNormal, std::uint32_t referenceFlag,
+                        CollisionHandler::CollisionInfo& info) {
+    size_t refEdge = mostAlignedEdge(reference, referenceNormal);
+    size_t incEdge = mostAlignedEdge(incident, -referenceNormal);
+
+    sf::Vector2f r0 = reference.vertices[refEdge];
+    sf::Vector2f r1 = reference.vertices[(refEdge + 1) % reference.vertexCount];
+    sf::Vector2f p0 = incident.vertices[incEdge];
+    sf::Vector2f p1 = incident.vertices[(incEdge + 1) % incident.vertexCount];
+    sf::Vector2f faceNormal = edgeNormal(reference, refEdge);
+
+    sf::Vector2f tangent = normalize(r1 - r0);
+    info.pointCount = 0;
+    if (clipSegment(p0, p1, tangent, dot(r0, tangent)) && clipSegment(p0, p1, -tangent, -dot(r1, tangent))) {
+        float faceOffset = dot(r0, faceNormal);
+        std::uint32_t edges = referenceFlag | static_cast<std::uint32_t>(refEdge) << 16 | static_cast<std::uint32_t>(incEdge) << 8;
+        const sf::Vector2f clipped[2] = {p0, p1};
+        for (std::uint32_t end = 0; end < 2; end++) {
+            float separation = dot(clipped[end], faceNormal) - faceOffset;
+            if (separation <= CollisionHandler::CONTACT_MARGIN) {
+                info.points[info.pointCount] = clipped[end];
+                info.depths[info.pointCount] = -separation;
+                info.features[info.pointCount] = edges | end;
+                info.pointCount++;
+            }
         }
-        
-        if (overlap < minOverlap) {
-            minOverlap = overlap;
-            collisionNormal = axis;
+    }
+
+    // Clipping can come up empty on grazing contacts; fall back to the
+    // incident vertex deepest through the reference face.
+    if (info.pointCount == 0) {
+        size_t deepest = 0;
+        for (size_t k = 1; k < incident.vertexCount; k++) {
+            if (dot(incident.vertices[k], referenceNormal) < dot(incident.vertices[deepest], referenceNormal)) {
+                deepest = k;
+            }
         }
+        info.points[0] = incident.vertices[deepest];
+        info.depths[0] = info.penetrationDepth;
+        info.features[0] = referenceFlag | 0x2000000u | static_cast<std::uint32_t>(deepest);
+        info.pointCount = 1;
     }
-    
-    for (size_t i = 0; i < polyB->vertices.size(); i++) {
-        sf::Vector2f edge = getEdge(polyB->vertices, i);
-        sf::Vector2f axis(-edge.y, edge.x);
-        axis = normalize(axis);
-        
-        float overlap = 0;
-        if (!checkOverlapOnAxis(axis, polyA->vertices, polyB->vertices, overlap)) {
-            return info;
+    info.point = info.points[0];
+}
+
+}
+
+CollisionHandler::CollisionInfo CollisionHandler::polygonVsPolygon(const ShapeView& polyA, const ShapeView& polyB) {
+    CollisionInfo info;
+    float minOverlap = std::numeric_limits<float>::max();
+    sf::Vector2f collisionNormal;
+    bool referenceIsA = true;
+
+    // Every edge normal of A then of B, projected in batches so the SIMD
+    // kernel tests several axes per instruction. Axes are still judged in
+    // that order, so the result matches testing them one at a time.
+    const size_t batch = SatKernels::MAX_AXES;
+    float axisX[batch] = {}, axisY[batch] = {};
+    float minA[batch], maxA[batch], minB[batch], maxB[batch];
+    size_t axisTotal = polyA.vertexCount + polyB.vertexCount;
+
+    for (size_t first = 0; first < axisTotal; first += batch) {
+        size_t count = std::min(batch, axisTotal - first);
+        for (size_t k = 0; k < count; k++) {
+            size_t edge = first + k;
+            sf::Vector2f axis = edge < polyA.vertexCount ? edgeNormal(polyA, edge)
+                                                         : edgeNormal(polyB, edge - polyA.vertexCount);
+            axisX[k] = axis.x;
+            axisY[k] = axis.y;
         }
-        
-        if (overlap < minOverlap) {
-            minOverlap = overlap;
-            collisionNormal = axis;
+        SatKernels::project(polyA.vertices, polyA.vertexCount, axisX, axisY, count, minA, maxA);
+        SatKernels::project(polyB.vertices, polyB.vertexCount, axisX, axisY, count, minB, maxB);
+
+        for (size_t k = 0; k < count; k++) {
+            if (maxA[k] < minB[k] || maxB[k] < minA[k]) {
+                return info;
+            }
+            float overlap = std::min(maxA[k] - minB[k], maxB[k] - minA[k]);
+
+            // Only switch the reference face to B when clearly better, so it
+            // doesn't flip back and forth between steps on near ties.
+            bool fromA = first + k < polyA.vertexCount;
+            if (fromA ? overlap < minOverlap : overlap < 0.98f * minOverlap - 0.001f) {
+                minOverlap = overlap;
+                collisionNormal = sf::Vector2f(axisX[k], axisY[k]);
+                referenceIsA = fromA;
+            }
         }
     }
     
-    sf::Vector2f centerDiff = polyB->com - polyA->com;
+    sf::Vector2f centerDiff = polyB.com - polyA.com;
     if (dot(centerDiff, collisionNormal) < 0) {
         collisionNormal = -collisionNormal;
     }
@@ -107,20 +341,25 @@ CollisionHandler::CollisionInfo CollisionHandler::polygonVsPolygon(RigidBody* po
     info.hasCollision = true;
     info.normal = collisionNormal;
     info.penetrationDepth = minOverlap;
-    
-    info.point = polyA->com + collisionNormal * (minOverlap / 2);
+
+    if (referenceIsA) {
+        clipPolygonContact(polyA, polyB, collisionNormal, 0, info);
+    } else {
+        clipPolygonContact(polyB, polyA, -collisionNormal, 0x1000000u, info);
+    }
     
     return info;
 }
 
-CollisionHandler::CollisionInfo CollisionHandler::circleVsPolygon(RigidBody* circle, RigidBody* poly) {
+CollisionHandler::CollisionInfo CollisionHandler::circleVsPolygon(const ShapeView& circle, const ShapeView& poly) {
     CollisionInfo info;
     
-    sf::Vector2f closestPoint = poly->vertices[0];
+    sf::Vector2f closestPoint = poly.vertices[0];
     float closestDistSq = std::numeric_limits<float>::max();
     
-    for (const auto& vertex : poly->vertices) {
-        sf::Vector2f diff = circle->com - vertex;
+    for (size_t i = 0; i < poly.vertexCount; i++) {
+        const sf::Vector2f& vertex = poly.vertices[i];
+        sf::Vector2f diff = circle.com - vertex;
         float distSq = diff.x * diff.x + diff.y * diff.y;
         
         if (distSq < closestDistSq) {
@@ -129,11 +368,11 @@ CollisionHandler::CollisionInfo CollisionHandler::circleVsPolygon(RigidBody* cir
         }
     }
     
-    for (size_t i = 0; i < poly->vertices.size(); i++) {
-        sf::Vector2f start = poly->vertices[i];
-        sf::Vector2f end = poly->vertices[(i + 1) % poly->vertices.size()];
+    for (size_t i = 0; i < poly.vertexCount; i++) {
+        sf::Vector2f start = poly.vertices[i];
+        sf::Vector2f end = poly.vertices[(i + 1) % poly.vertexCount];
         sf::Vector2f edge = end - start;
-        sf::Vector2f circleToStart = circle->com - start;
+        sf::Vector2f circleToStart = circle.com - start;
         
         float projection = dot(circleToStart, edge) / dot(edge, edge);
         
@@ -141,7 +380,7 @@ CollisionHandler::CollisionInfo CollisionHandler::circleVsPolygon(RigidBody* cir
         
         sf::Vector2f pointOnEdge = start + projection * edge;
         
-        sf::Vector2f diff = circle->com - pointOnEdge;
+        sf::Vector2f diff = circle.com - pointOnEdge;
         float distSq = diff.x * diff.x + diff.y * diff.y;
         
         if (distSq < closestDistSq) {
@@ -150,87 +389,72 @@ CollisionHandler::CollisionInfo CollisionHandler::circleVsPolygon(RigidBody* cir
         }
     }
     
-    sf::Vector2f delta = closestPoint - circle->com;
+    sf::Vector2f delta = closestPoint - circle.com;
     float distance = vectorLength(delta);
     
-    if (distance < circle->radius) {
+    if (distance < circle.radius) {
         info.hasCollision = true;
         info.normal = normalize(delta);
-        info.penetrationDepth = circle->radius - distance;
+        info.penetrationDepth = circle.radius - distance;
         info.point = closestPoint;
+        info.points[0] = info.point;
+        info.depths[0] = info.penetrationDepth;
+        info.pointCount = 1;
     }
     
     return info;
 }
 
-bool CollisionHandler::checkOverlapOnAxis(const sf::Vector2f& axis, 
-                                         const std::vector<sf::Vector2f>& vertsA, 
-                                         const std::vector<sf::Vector2f>& vertsB,
-                                         float& overlap) {
-    float minA = std::numeric_limits<float>::max();
-    float maxA = std::numeric_limits<float>::lowest();
-    float minB = std::numeric_limits<float>::max();
-    float maxB = std::numeric_limits<float>::lowest();
-    
-    for (const auto& v : vertsA) {
-        float proj = dot(v, axis);
-        minA = std::min(minA, proj);
-        maxA = std::max(maxA, proj);
-    }
-    
-    for (const auto& v : vertsB) {
-        float proj = dot(v, axis);
-        minB = std::min(minB, proj);
-        maxB = std::max(maxB, proj);
-    }
-    
-    float overlapAB = maxA - minB;
-    float overlapBA = maxB - minA;
-    
-    if (maxA < minB || maxB < minA) {
-        return false;
-    }
-    
-    overlap = std::min(overlapAB, overlapBA);
-    return true;
-}
-
-void CollisionHandler::resolveCollision(RigidBody* bodyA, RigidBody* bodyB, const CollisionInfo& info) {
-    if (!info.hasCollision) return;
-    
+bool CollisionHandler::computeResponse(const sf::Vector2f& relativeVelocity, float invMassA, float invMassB,
+                                       const CollisionInfo& info, sf::Vector2f& impulse, sf::Vector2f& correction) {
     const float restitution = 0.6f;
     
-    sf::Vector2f relativeVelocity = bodyB->velocity - bodyA->velocity;
-    
     float velAlongNormal = dot(relativeVelocity, info.normal);
     
-    if (velAlongNormal > 0) return;
+    if (velAlongNormal > 0) return false;
+
+    float invMassSum = invMassA + invMassB;
+    if (invMassSum <= 0) return false;
     
     float j = -(1.0f + restitution) * velAlongNormal;
-    j /= (1.0f / bodyA->mass) + (1.0f / bodyB->mass);
+    j /= invMassSum;
     
-    sf::Vector2f impulse = j * info.normal;
-    
-    bodyA->velocity -= impulse / bodyA->mass;
-    bodyB->velocity += impulse / bodyB->mass;
+    impulse = j * info.normal;
     
     const float percent = 0.2f;
     const float slop = 0.01f;
     
-    sf::Vector2f correction = std::max(info.penetrationDepth - slop, 0.0f) * percent * 
-                              info.normal / ((1.0f / bodyA->mass) + (1.0f / bodyB->mass));
-    
-    bodyA->com -= correction / bodyA->mass;
-    bodyB->com += correction / bodyB->mass;
-    
-    sf::Vector2f correctA = -correction / bodyA->mass;
-    sf::Vector2f correctB = correction / bodyB->mass;
-    
-    for (auto& vertex : bodyA->vertices) {
-        vertex += correctA;
-    }
-    
-    for (auto& vertex : bodyB->vertices) {
-        vertex += correctB;
-    }
+    correction = std::max(info.penetrationDepth - slop, 0.0f) * percent * 
+                 info.normal / invMassSum;
+    return true;
+}
+
+void CollisionHandler::resolveCollision(ParticleSystem& particles, size_t particle, BodyStore& store, size_t body, const CollisionInfo& info) {
+    if (!info.hasCollision) return;
+
+    float invMassA = particles.invMass[particle];
+    // Sleeping bodies act as immovable so particles don't build up velocity on them.
+    bool bodyAwake = store.awake[body] != 0;
+    float invMassB = bodyAwake ? store.invMass[body] : 0.0f;
+    float invInertiaB = bodyAwake ? store.invInertia[body] : 0.0f;
+
+    // Particles don't spin, but the body is hit off-centre.
+    sf::Vector2f r = info.point - store.position(body);
+    float rn = r.x * info.normal.y - r.y * info.normal.x;
+    float spin = store.angularVel[body];
+    sf::Vector2f bodyVelocity = store.velocity(body) + sf::Vector2f(-spin * r.y, spin * r.x);
+    sf::Vector2f relativeVelocity = bodyVelocity - particles.velocity(particle);
+
+    sf::Vector2f impulse, correction;
+    if (!computeResponse(relativeVelocity, invMassA, invMassB + invInertiaB * rn * rn, info, impulse, correction)) return;
+
+    particles.velX[particle] -= impulse.x * invMassA;
+    particles.velY[particle] -= impulse.y * invMassA;
+    store.velX[body] += impulse.x * invMassB;
+    store.velY[body] += impulse.y * invMassB;
+    store.angularVel[body] += invInertiaB * (r.x * impulse.y - r.y * impulse.x);
+
+    particles.posX[particle] -= correction.x * invMassA;
+    particles.posY[particle] -= correction.y * invMassA;
+    store.translate(body, correction * invMassB);
 }
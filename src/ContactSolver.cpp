@@ -0,0 +1,292 @@
+#include "ContactSolver.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const float restitution = 0.6f;
+// Slower approaches are treated as resting contact, otherwise the velocity
+// gravity adds each step gets bounced back and stacks never come to rest.
+const float restitutionThreshold = 30.0f;
+const float friction = 0.4f;
+const float correctionPercent = 0.2f;
+const float slop = 0.01f;
+
+float dot(const sf::Vector2f& a, const sf::Vector2f& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+float cross(const sf::Vector2f& a, const sf::Vector2f& b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// Velocity of the point at offset r from body i's centre of mass.
+sf::Vector2f pointVelocity(const BodyStore& bodies, size_t i, const sf::Vector2f& r) {
+    if (i == CollisionHandler::WORLD) return sf::Vector2f(0, 0);
+    return sf::Vector2f(bodies.velX[i] - bodies.angularVel[i] * r.y, bodies.velY[i] + bodies.angularVel[i] * r.x);
+}
+
+}
+
+std::uint32_t ContactSolver::find(std::uint32_t body) {
+    // A body no contact of this solve reached is its own island.
+    if (parentStamp[body] != islandStamp) return body;
+    while (parent[body] != body) {
+        parent[body] = parent[parent[body]];
+        body = parent[body];
+    }
+    return body;
+}
+
+void ContactSolver::unite(std::uint32_t a, std::uint32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    for (std::uint32_t root : {a, b}) {
+        if (parentStamp[root] != islandStamp) {
+            parentStamp[root] = islandStamp;
+            parent[root] = root;
+        }
+    }
+    // Lower index wins so the roots don't depend on contact order.
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+void ContactSolver::buildIslands(const BodyStore& bodies, const std::vector<CollisionHandler::Contact>& contacts) {
+    // Only bodies reached by a contact get a parent entry, stamped with this
+    // solve, so the cost follows the contacts rather than the body count.
+    size_t bodyCount = bodies.size();
+    parent.resize(bodyCount);
+    parentStamp.resize(bodyCount, 0);
+    islandOfRoot.resize(bodyCount, NO_ISLAND);
+    islandStamp++;
+    for (const auto& contact : contacts) {
+        if (contact.bodyB == CollisionHandler::WORLD || bodies.type[contact.bodyB] != BodyType::DYNAMIC) continue;
+        unite(static_cast<std::uint32_t>(contact.bodyA), static_cast<std::uint32_t>(contact.bodyB));
+    }
+
+    // Number islands by root body and bucket the contacts with a counting sort.
+    std::vector<std::uint32_t> contactIsland(contacts.size());
+    std::uint32_t islandCount = 0;
+    for (size_t c = 0; c < contacts.size(); c++) {
+        std::uint32_t root = find(static_cast<std::uint32_t>(contacts[c].bodyA));
+        if (islandOfRoot[root] == NO_ISLAND) {
+            islandOfRoot[root] = islandCount++;
+        }
+        contactIsland[c] = islandOfRoot[root];
+    }
+    for (const auto& contact : contacts) {
+        islandOfRoot[find(static_cast<std::uint32_t>(contact.bodyA))] = NO_ISLAND;
+    }
+
+    islandStart.assign(islandCount + 1, 0);
+    for (std::uint32_t island : contactIsland) {
+        islandStart[island + 1]++;
+    }
+    for (std::uint32_t k = 0; k < islandCount; k++) {
+        islandStart[k + 1] += islandStart[k];
+    }
+
+    islandContacts.resize(contacts.size());
+    std::vector<size_t> fill(islandStart.begin(), islandStart.end() - 1);
+    for (size_t c = 0; c < contacts.size(); c++) {
+        islandContacts[fill[contactIsland[c]]++] = c;
+    }
+}
+
+ContactSolver::CachedManifold& ContactSolver::findPair(const BodyStore& bodies, const CollisionHandler::Contact& contact) {
+    bool world = contact.bodyB == CollisionHandler::WORLD;
+    BodyHandle a = bodies.handleAt(contact.bodyA);
+    BodyHandle b = world ? BodyHandle() : bodies.handleAt(contact.bodyB);
+
+    auto inserted = pairs.emplace(PairKey{a.id, b.id, contact.wall}, CachedManifold());
+    CachedManifold& cache = inserted.first->second;
+    // A reused id belongs to a new body; its impulses mean nothing here.
+    if (inserted.second || cache.generationA != a.generation || cache.generationB != b.generation) {
+        cache.generationA = a.generation;
+        cache.generationB = b.generation;
+        cache.pointCount = 0;
+    }
+    cache.lastStep = stepCount;
+    return cache;
+}
+
+void ContactSolver::prunePairs(const BodyStore& bodies) {
+    // Pairs that stopped touching are dropped, except between sleeping
+    // bodies: those produce no contacts but should wake up warm.
+    auto asleep = [&bodies](std::uint32_t id, std::uint32_t generation) {
+        if (id == BodyHandle::INVALID) return true;
+        BodyHandle handle;
+        handle.id = id;
+        handle.generation = generation;
+        return bodies.contains(handle) && !bodies.awake[bodies.indexOf(handle)];
+    };
+
+    for (auto it = pairs.begin(); it != pairs.end();) {
+        const CachedManifold& cache = it->second;
+        bool keep = cache.lastStep == stepCount ||
+                    (asleep(it->first.idA, cache.generationA) && asleep(it->first.idB, cache.generationB));
+        it = keep ? std::next(it) : pairs.erase(it);
+    }
+}
+
+void ContactSolver::solve(BodyStore& bodies, const std::vector<CollisionHandler::Contact>& contacts, float dt, ThreadPool& pool) {
+    buildIslands(bodies, contacts);
+    stepCount++;
+    warmStartedPoints = 0;
+
+    solverContacts.resize(contacts.size());
+    for (size_t c = 0; c < contacts.size(); c++) {
+        const auto& contact = contacts[c];
+        SolverContact& sc = solverContacts[c];
+        sc.bodyA = contact.bodyA;
+        sc.bodyB = contact.bodyB;
+        sc.invMassA = bodies.invMass[sc.bodyA];
+        sc.invInertiaA = bodies.invInertia[sc.bodyA];
+        bool world = sc.bodyB == CollisionHandler::WORLD;
+        sc.invMassB = world ? 0.0f : bodies.invMass[sc.bodyB];
+        sc.invInertiaB = world ? 0.0f : bodies.invInertia[sc.bodyB];
+        sc.fixedB = world || bodies.type[sc.bodyB] != BodyType::DYNAMIC;
+        sc.normal = contact.info.normal;
+        sc.pointCount = std::max(1, contact.info.pointCount);
+        sc.cache = &findPair(bodies, contact);
+
+        sf::Vector2f tangent(-sc.normal.y, sc.normal.x);
+        for (int p = 0; p < sc.pointCount; p++) {
+            SolverPoint& sp = sc.points[p];
+            sf::Vector2f point = contact.info.pointCount > 0 ? contact.info.points[p] : contact.info.point;
+            sp.depth = contact.info.pointCount > 0 ? contact.info.depths[p] : contact.info.penetrationDepth;
+            sp.rA = point - bodies.position(sc.bodyA);
+            sp.rB = world ? sf::Vector2f(0, 0) : point - bodies.position(sc.bodyB);
+            sp.normalMass = effectiveMass(sc, sp, sc.normal);
+            sp.tangentMass = effectiveMass(sc, sp, tangent);
+
+            // Bounce off the approach speed measured before any impulse is applied.
+            sf::Vector2f relativeVelocity = pointVelocity(bodies, sc.bodyB, sp.rB) - pointVelocity(bodies, sc.bodyA, sp.rA);
+            float velAlongNormal = dot(relativeVelocity, sc.normal);
+            sp.velocityBias = velAlongNormal < -restitutionThreshold ? -restitution * velAlongNormal : 0.0f;
+            // A point that isn't touching yet (negative depth, inside the wall
+            // margin) may still close its gap this step, but no further.
+            if (sp.depth < 0.0f) {
+                sp.velocityBias = sp.depth / dt;
+            }
+
+            sp.feature = contact.info.features[p];
+            sp.normalImpulse = 0.0f;
+            sp.tangentImpulse = 0.0f;
+            for (int q = 0; warmStarting && q < sc.cache->pointCount; q++) {
+                if (sc.cache->points[q].feature == sp.feature) {
+                    sp.normalImpulse = sc.cache->points[q].normalImpulse;
+                    sp.tangentImpulse = sc.cache->points[q].tangentImpulse;
+                    warmStartedPoints++;
+                    break;
+                }
+            }
+        }
+    }
+
+    pool.parallelFor(getIslandCount(), 4, [&](size_t begin, size_t end, size_t) {
+        PROFILE_ZONE("Solve islands");
+        for (size_t island = begin; island < end; island++) {
+            solveIsland(bodies, island);
+        }
+    });
+
+    prunePairs(bodies);
+}
+
+float ContactSolver::effectiveMass(const SolverContact& sc, const SolverPoint& sp, const sf::Vector2f& direction) {
+    float rnA = cross(sp.rA, direction);
+    float rnB = cross(sp.rB, direction);
+    float k = sc.invMassA + sc.invMassB + sc.invInertiaA * rnA * rnA + sc.invInertiaB * rnB * rnB;
+    return k > 0 ? 1.0f / k : 0.0f;
+}
+
+void ContactSolver::applyImpulse(BodyStore& bodies, const SolverContact& sc, const SolverPoint& sp, const sf::Vector2f& impulse) {
+    size_t a = sc.bodyA;
+    bodies.velX[a] -= impulse.x * sc.invMassA;
+    bodies.velY[a] -= impulse.y * sc.invMassA;
+    bodies.angularVel[a] -= cross(sp.rA, impulse) * sc.invInertiaA;
+    if (sc.fixedB) return;
+
+    size_t b = sc.bodyB;
+    bodies.velX[b] += impulse.x * sc.invMassB;
+    bodies.velY[b] += impulse.y * sc.invMassB;
+    bodies.angularVel[b] += cross(sp.rB, impulse) * sc.invInertiaB;
+}
+
+void ContactSolver::solveIsland(BodyStore& bodies, size_t island) {
+    size_t first = islandStart[island];
+    size_t last = islandStart[island + 1];
+
+    // Reapply last step's impulses before iterating; they are zero for
+    // points that are new this step.
+    for (size_t k = first; k < last; k++) {
+        const SolverContact& sc = solverContacts[islandContacts[k]];
+        sf::Vector2f tangent(-sc.normal.y, sc.normal.x);
+        for (int p = 0; p < sc.pointCount; p++) {
+            const SolverPoint& sp = sc.points[p];
+            applyImpulse(bodies, sc, sp, sp.normalImpulse * sc.normal + sp.tangentImpulse * tangent);
+        }
+    }
+
+    for (int iter = 0; iter < iterations; iter++) {
+        for (size_t k = first; k < last; k++) {
+            SolverContact& sc = solverContacts[islandContacts[k]];
+            sf::Vector2f tangent(-sc.normal.y, sc.normal.x);
+
+            for (int p = 0; p < sc.pointCount; p++) {
+                SolverPoint& sp = sc.points[p];
+
+                // Friction first, bounded by the normal impulse found so far.
+                sf::Vector2f relativeVelocity = pointVelocity(bodies, sc.bodyB, sp.rB) - pointVelocity(bodies, sc.bodyA, sp.rA);
+                float lambda = -dot(relativeVelocity, tangent) * sp.tangentMass;
+                float maxFriction = friction * sp.normalImpulse;
+                float previous = sp.tangentImpulse;
+                sp.tangentImpulse = std::max(-maxFriction, std::min(previous + lambda, maxFriction));
+                applyImpulse(bodies, sc, sp, (sp.tangentImpulse - previous) * tangent);
+
+                relativeVelocity = pointVelocity(bodies, sc.bodyB, sp.rB) - pointVelocity(bodies, sc.bodyA, sp.rA);
+                lambda = (sp.velocityBias - dot(relativeVelocity, sc.normal)) * sp.normalMass;
+
+                // Clamp the total, not the increment, so later iterations can
+                // take back impulse that turned out to be too much.
+                previous = sp.normalImpulse;
+                sp.normalImpulse = std::max(previous + lambda, 0.0f);
+                applyImpulse(bodies, sc, sp, (sp.normalImpulse - previous) * sc.normal);
+            }
+        }
+    }
+
+    // Each contact has its own cache entry, so islands can write them in parallel.
+    for (size_t k = first; k < last; k++) {
+        const SolverContact& sc = solverContacts[islandContacts[k]];
+        sc.cache->pointCount = sc.pointCount;
+        for (int p = 0; p < sc.pointCount; p++) {
+            sc.cache->points[p] = {sc.points[p].feature, sc.points[p].normalImpulse, sc.points[p].tangentImpulse};
+        }
+    }
+
+    // Push overlapping bodies apart through each manifold point. Linear only:
+    // turning bodies here fed energy into tall stacks once warm starting held
+    // them up, and the velocity pass already levels a body that sank in at one
+    // corner. integrateBodies rebuilds the vertices.
+    for (size_t k = first; k < last; k++) {
+        const SolverContact& sc = solverContacts[islandContacts[k]];
+        for (int p = 0; p < sc.pointCount; p++) {
+            const SolverPoint& sp = sc.points[p];
+            float magnitude = std::max(sp.depth - slop, 0.0f) * correctionPercent * sp.normalMass / sc.pointCount;
+            if (magnitude <= 0.0f) continue;
+            sf::Vector2f correction = magnitude * sc.normal;
+
+            bodies.posX[sc.bodyA] -= correction.x * sc.invMassA;
+            bodies.posY[sc.bodyA] -= correction.y * sc.invMassA;
+            if (!sc.fixedB) {
+                bodies.posX[sc.bodyB] += correction.x * sc.invMassB;
+                bodies.posY[sc.bodyB] += correction.y * sc.invMassB;
+            }
+        }
+    }
+}
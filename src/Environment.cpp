@@ -1,10 +1,12 @@
 #include "Environment.hpp"
+#include <chrono>
 #include <cmath>
-#include <iostream>
-#include <random>
 #include <sstream>
 #include <iomanip>
 #include "CollisionHandler.hpp"
+#include "Logger.hpp"
+#include "Profiler.hpp"
+#include "Snapshot.hpp"
 
 UserInput::UserInput(Environment& env) 
     : environment(env), dragging(false) {
@@ -13,7 +15,7 @@ UserInput::UserInput(Environment& env)
 void UserInput::handleInput(sf::Event event) {
     ShapeType currMode = environment.getCurrentMode();
     sf::RenderWindow& window = environment.getWindow();
-    sf::Vector2f mousePosition(sf::Mouse::getPosition(window));
+    sf::Vector2f mousePosition = environment.toWorld(sf::Mouse::getPosition(window));
     
     if (currMode == ShapeType::LIQUID) {
         if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
@@ -26,24 +28,27 @@ void UserInput::handleInput(sf::Event event) {
         if (currMode == ShapeType::CIRCLE) {
             if (tempVertices.empty()) {
                 tempVertices.push_back(mousePosition);
-                std::cout << "Circle center selected.\n";
+                LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Circle center selected";
             } 
             else {
                 float radius = std::hypot(tempVertices[0].x - mousePosition.x, tempVertices[0].y - mousePosition.y);
-                std::cout << "Circle radius calculated: " << radius << "\n";
+                LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Circle radius calculated: " << radius;
 
                 sf::Vector2f center = tempVertices[0];
-                auto windowSize = window.getSize();
-
-                if (center.x - radius < 0) radius = center.x;
-                if (center.x + radius > windowSize.x) radius = windowSize.x - center.x;
-                if (center.y - radius < 0) radius = center.y;
-                if (center.y + radius > windowSize.y) radius = windowSize.y - center.y;
+                PhysicsWorld& world = environment.getWorld();
+                if (world.areWallsEnabled()) {
+                    const sf::FloatRect& bounds = world.getBounds();
+                    float right = bounds.left + bounds.width;
+                    float bottom = bounds.top + bounds.height;
+
+                    if (center.x - radius < bounds.left) radius = center.x - bounds.left;
+                    if (center.x + radius > right) radius = right - center.x;
+                    if (center.y - radius < bounds.top) radius = center.y - bounds.top;
+                    if (center.y + radius > bottom) radius = bottom - center.y;
+                }
 
-                RigidBody* circle = new RigidBody(center, radius, {0, 0}, {0, 0}, sf::Color::Blue);
-                circle->addForce(new Gravity(0, 1000.0f));
-                environment.addRigidBody(circle);
-                std::cout << "Circle created.\n";
+                environment.createCircle(center, radius);
+                LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Circle created";
 
                 tempVertices.clear();
             }
@@ -107,33 +112,139 @@ void UserInput::drawPreview(sf::RenderWindow& window) {
     }
 }
 
-Environment::Environment(int width, int height, const std::string& title)
+Environment::Environment(int width, int height, const std::string& title, const sf::Vector2f& worldSize)
     : window(sf::VideoMode(width, height), title), 
       currMode(ShapeType::RECTANGLE),
-      userInput(*this) {
+      userInput(*this),
+      world(worldSize.x, worldSize.y),
+      profilerOverlay(font) {
     
     if (!font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf")) {
-        std::cout << "No font could be loaded" << std::endl;
+        LOG(LogCategory::VIEWER, LogLevel::WARNING) << "No font could be loaded";
     }
     
     mainView = window.getDefaultView();
+    mainView.setCenter(width / 2.0f, worldSize.y - height / 2.0f);
+    clampCamera();
     
     setupGUI();
     setupPropertiesPanel();
+
+    statsText.setFont(font);
+    statsText.setCharacterSize(12);
+    statsText.setFillColor(sf::Color::White);
+    statsText.setPosition(10.0f, 50.0f);
+
+    // Sits to the left of the properties panel.
+    profilerOverlay.setPosition(sf::Vector2f(window.getSize().x - 500.0f, 50.0f));
 }
 
-void Environment::updateGravityOnObjects() {
-    sf::Vector2f newGravity(gravityX, gravityY);
-    
-    for (auto* obj : rigidobjs) {
-        obj->removeForcesByType(ForceType::GRAVITY);
-        obj->addForce(new Gravity(newGravity.x, newGravity.y));
+void Environment::saveProfilerTrace() {
+    const std::string path = "physics_trace.json";
+    if (Profiler::get().writeChromeTrace(path)) {
+        LOG(LogCategory::PROFILER, LogLevel::INFO) << "Trace written to " << path;
+    } else {
+        LOG(LogCategory::PROFILER, LogLevel::ERROR) << "Could not write trace to " << path;
     }
-    
-    for (auto* particle : liquidobjs) {
-        particle->removeForcesByType(ForceType::GRAVITY);
-        particle->addForce(new Gravity(newGravity.x, newGravity.y));
+}
+
+namespace {
+const char* const SNAPSHOT_PATH = "physics_snapshot.bin";
+const float MIN_ZOOM = 0.25f;
+const float PAN_SPEED = 900.0f;     // screen pixels per second
+const float CULL_MARGIN = 32.0f;
+}
+
+void Environment::saveSnapshot() {
+    if (pendingSave.valid()) {
+        LOG(LogCategory::VIEWER, LogLevel::WARNING) << "Still writing the last snapshot";
+        return;
+    }
+    Snapshot::Settings settings = {
+        {"defaultDensity", defaultDensity},
+        {"liquidDensity", liquidDensity},
+        {"gravityX", gravityX},
+        {"gravityY", gravityY},
+        {"liquidLifetime", liquidLifetime},
+        {"liquidFadeFactor", liquidFadeFactor},
+    };
+    // Only the capture holds up the frame; the file is written in the background.
+    pendingSave = Snapshot::saveAsync(world, SNAPSHOT_PATH, settings);
+}
+
+void Environment::checkPendingSave() {
+    if (!pendingSave.valid() || pendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    if (pendingSave.get()) {
+        LOG(LogCategory::VIEWER, LogLevel::INFO) << "Snapshot saved to " << SNAPSHOT_PATH;
+    }
+}
+
+void Environment::loadSnapshot() {
+    Snapshot snapshot;
+    if (!snapshot.open(SNAPSHOT_PATH)) {
+        return;
+    }
+    if (!snapshot.restore(world)) {
+        return;
     }
+    LOG(LogCategory::VIEWER, LogLevel::INFO) << "Snapshot loaded from " << SNAPSHOT_PATH;
+    // Sliders only once the world is restored. The world already holds gravity
+    // and liquid density, and setting them again would wake every body.
+    const Snapshot::Settings& settings = snapshot.getSettings();
+    auto apply = [&settings](const char* key, gui::Slider& slider) {
+        auto it = settings.find(key);
+        if (it != settings.end()) slider.setValue(it->second);
+    };
+    apply("defaultDensity", *densitySlider);
+    apply("liquidLifetime", *lifetimeSlider);
+    apply("liquidFadeFactor", *fadeFactorSlider);
+    auto show = [&settings](const char* key, gui::Slider& slider, float& value) {
+        auto it = settings.find(key);
+        if (it != settings.end()) value = it->second;
+        slider.showValue(value);
+    };
+    show("liquidDensity", *liquidDensitySlider, liquidDensity);
+    gravityX = world.getGravity().x;
+    gravityY = world.getGravity().y;
+    gravityXSlider->showValue(gravityX);
+    gravityYSlider->showValue(gravityY);
+    recorder.recordKeyframe(true);
+}
+
+void Environment::toggleRecording() {
+    if (recorder.isRecording()) {
+        recorder.stop();
+        LOG(LogCategory::VIEWER, LogLevel::INFO) << "Recording stopped";
+        return;
+    }
+    if (recorder.start("physics_recording.bin", world)) {
+        recorder.recordSetting("defaultDensity", defaultDensity);
+        recorder.recordSetting("liquidLifetime", liquidLifetime);
+        recorder.recordSetting("liquidFadeFactor", liquidFadeFactor);
+    }
+}
+
+void Environment::updateStatsText() {
+    std::stringstream stream;
+    const CollisionStats& collisionStats = world.getCollisionStats();
+    stream << (world.getBroadPhaseType() == BroadPhaseType::SPATIAL_HASH ? "Spatial hash" : "Sweep and prune")
+           << " (B to switch)\n"
+           << "Bodies: " << collisionStats.candidatePairs << " candidates / "
+           << collisionStats.contacts << " contacts, " << collisionStats.islands << " islands\n"
+           << "Awake: " << collisionStats.awakeBodies << ", sleeping: " << collisionStats.sleepingBodies
+           << ", static: " << collisionStats.staticBodies << " (S to place " << (placeStatic ? "dynamic" : "static") << ")\n"
+           << "Liquid (" << (world.getParticles().getModel() == LiquidModel::SPH ? "SPH" : "ballistic")
+           << ", L to switch): " << collisionStats.particleCandidates << " candidates / "
+           << collisionStats.particleContacts << " contacts\n"
+           << "Drawn: " << visibleBodies.size() << " of " << world.getBodies().size() << " bodies"
+           << " (arrows or right drag to pan, W for walls)";
+    statsText.setString(stream.str());
+}
+
+void Environment::updateGravityOnObjects() {
+    world.setGravity(sf::Vector2f(gravityX, gravityY));
 }
 
 void Environment::setupPropertiesPanel() {
@@ -160,6 +271,7 @@ void Environment::setupPropertiesPanel() {
     
     densitySlider->setCallback([this](float value) {
         defaultDensity = value;
+        recorder.recordSetting("defaultDensity", value);
     });
     
     liquidDensitySlider = gui.addWidget<gui::Slider>(
@@ -171,6 +283,7 @@ void Environment::setupPropertiesPanel() {
     
     liquidDensitySlider->setCallback([this](float value) {
         liquidDensity = value;
+        world.setLiquidDensity(value);
     });
     
     gravityXSlider = gui.addWidget<gui::Slider>(
@@ -206,6 +319,7 @@ void Environment::setupPropertiesPanel() {
     
     lifetimeSlider->setCallback([this](float value) {
         liquidLifetime = value;
+        recorder.recordSetting("liquidLifetime", value);
     });
     
     fadeFactorSlider = gui.addWidget<gui::Slider>(
@@ -217,6 +331,7 @@ void Environment::setupPropertiesPanel() {
     
     fadeFactorSlider->setCallback([this](float value) {
         liquidFadeFactor = value;
+        recorder.recordSetting("liquidFadeFactor", value);
     });
 }
 
@@ -315,6 +430,17 @@ void Environment::setupGUI() {
         sf::Color(80, 180, 200)
     );
     
+    profilerButton = gui.addWidget<gui::ToggleButton>(
+        sf::Vector2f(window.getSize().x - (buttonWidth * 3) - buttonSpacing * 2 - 10, window.getSize().y - buttonHeight - 10),
+        sf::Vector2f(buttonWidth, buttonHeight),
+        "Profiler shown", "Profiler",
+        font, 14,
+        sf::Color(100, 100, 100),
+        sf::Color(150, 150, 150),
+        sf::Color(20, 20, 20),
+        sf::Color(220, 200, 80)
+    );
+    
    zoomInButton = gui.addWidget<gui::Button>(
         sf::Vector2f(startX, window.getSize().y - buttonHeight - 10),
         sf::Vector2f(buttonWidth/2, buttonHeight),
@@ -367,19 +493,15 @@ void Environment::setupGUI() {
 
     deletebutton->setToggleCallback([this](bool toggled) {
         if (toggled) {
-            if (!rigidobjs.empty()) {
-                delete rigidobjs.back();
-                rigidobjs.pop_back();
-                std::cout << "Last object deleted.\n";
+            if (world.getBodies().size() > 0) {
+                world.removeLastRigidBody();
+                LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Last object deleted";
             }
         }
     });
 
     clearbutton->setCallback([this]() {
-        for (auto* obj : rigidobjs) {
-            delete obj;
-        }
-        rigidobjs.clear();
+        world.clear();
     });
 
     pausebutton->setToggleCallback([this](bool toggled) {
@@ -391,6 +513,10 @@ void Environment::setupGUI() {
         }
     });
     
+    profilerButton->setToggleCallback([this](bool toggled) {
+        profilerOverlay.setVisible(toggled);
+    });
+    
     zoomInButton->setCallback([this]() {
         zoomIn();
     });
@@ -410,7 +536,7 @@ void Environment::zoomIn() {
 }
 
 void Environment::zoomOut() {
-    if (zoomLevel > 1.0f) {
+    if (zoomLevel > MIN_ZOOM) {
         zoomLevel /= 1.2f;
         updateZoom();
     }
@@ -424,10 +550,54 @@ void Environment::updateZoom() {
     mainView.zoom(1.0f / zoomLevel);
     
     mainView.setCenter(center);
+    clampCamera();
     
     window.setView(mainView);
     
-    std::cout << "Zoom level: " << zoomLevel << std::endl;
+    LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Zoom level: " << zoomLevel;
+}
+
+void Environment::updateCamera(float frameTime) {
+    if (!window.hasFocus()) return;
+    sf::Vector2f direction;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) direction.x -= 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) direction.x += 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) direction.y -= 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) direction.y += 1.0f;
+    if (direction.x != 0 || direction.y != 0) {
+        // Same speed on screen at any zoom.
+        panCamera(direction * (PAN_SPEED * frameTime / zoomLevel));
+    }
+}
+
+void Environment::panCamera(const sf::Vector2f& offset) {
+    mainView.move(offset);
+    clampCamera();
+}
+
+// Keeps the view over the world; a view wider than the world stays centred on it.
+void Environment::clampCamera() {
+    const sf::FloatRect& bounds = world.getBounds();
+    sf::Vector2f half = mainView.getSize() / 2.0f;
+    sf::Vector2f center = mainView.getCenter();
+    auto clampAxis = [](float c, float half, float lo, float size) {
+        if (2.0f * half >= size) return lo + size / 2.0f;
+        return std::min(lo + size - half, std::max(lo + half, c));
+    };
+    center.x = clampAxis(center.x, half.x, bounds.left, bounds.width);
+    center.y = clampAxis(center.y, half.y, bounds.top, bounds.height);
+    mainView.setCenter(center);
+}
+
+AABB Environment::visibleArea() const {
+    sf::Vector2f half = mainView.getSize() / 2.0f;
+    // The broad phase holds the bounds from the end of the last step, and
+    // bodies are drawn up to a step behind that; the margin covers the gap.
+    sf::Vector2f margin(CULL_MARGIN, CULL_MARGIN);
+    AABB area;
+    area.min = mainView.getCenter() - half - margin;
+    area.max = mainView.getCenter() + half + margin;
+    return area;
 }
 
 void Environment::setShapeType(ShapeType type) {
@@ -438,18 +608,31 @@ void Environment::setShapeType(ShapeType type) {
     circleButton->setToggled(type == ShapeType::CIRCLE);
     liquidButton->setToggled(type == ShapeType::LIQUID);
     
-    std::cout << "Switched to " << getShapeTypeName(currMode) << " mode" << std::endl;
+    LOG(LogCategory::VIEWER, LogLevel::INFO) << "Switched to " << getShapeTypeName(currMode) << " mode";
 }
 
 void Environment::run() {
-    mainView = window.getDefaultView();
-    
     while (window.isOpen()) {
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed)
                 window.close();
                 
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
+                panning = true;
+                panFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            }
+
+            if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right) {
+                panning = false;
+            }
+
+            if (event.type == sf::Event::MouseMoved && panning) {
+                sf::Vector2i to(event.mouseMove.x, event.mouseMove.y);
+                panCamera(toWorld(panFrom) - toWorld(to));
+                panFrom = to;
+            }
+
             if (event.type == sf::Event::MouseWheelScrolled) {
                 if (event.mouseWheelScroll.delta > 0) {
                     zoomIn();
@@ -470,10 +653,66 @@ void Environment::run() {
                 else
                     setShapeType(ShapeType::RECTANGLE);
             }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::L) {
+                if (world.getParticles().getModel() == LiquidModel::SPH)
+                    world.setLiquidModel(LiquidModel::BALLISTIC);
+                else
+                    world.setLiquidModel(LiquidModel::SPH);
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::B) {
+                if (world.getBroadPhaseType() == BroadPhaseType::SWEEP_AND_PRUNE)
+                    world.setBroadPhase(BroadPhaseType::SPATIAL_HASH);
+                else
+                    world.setBroadPhase(BroadPhaseType::SWEEP_AND_PRUNE);
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::W) {
+                world.setWallsEnabled(!world.areWallsEnabled());
+                LOG(LogCategory::VIEWER, LogLevel::INFO) << "World walls "
+                                                         << (world.areWallsEnabled() ? "on" : "off");
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S) {
+                placeStatic = !placeStatic;
+                LOG(LogCategory::VIEWER, LogLevel::INFO) << "Placing " << (placeStatic ? "static" : "dynamic") << " shapes";
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::V) {
+                bool verlet = world.getIntegrationScheme() != IntegrationScheme::VELOCITY_VERLET;
+                world.setIntegrationScheme(verlet ? IntegrationScheme::VELOCITY_VERLET
+                                                  : IntegrationScheme::SEMI_IMPLICIT_EULER);
+                LOG(LogCategory::VIEWER, LogLevel::INFO) << "Integrating with "
+                                                         << (verlet ? "velocity Verlet" : "semi-implicit Euler");
+            }
+            
+            // P shows the profiler, O saves its history as a Chrome trace.
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P) {
+                profilerOverlay.toggle();
+                profilerButton->setToggled(profilerOverlay.isVisible());
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::O) {
+                saveProfilerTrace();
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F5) {
+                saveSnapshot();
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9) {
+                loadSnapshot();
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+                toggleRecording();
+            }
             
             userInput.handleInput(event);
         }
 
+        updateCamera(cameraClock.restart().asSeconds());
        
         if (!isPaused) {
             update();
@@ -484,70 +723,54 @@ void Environment::run() {
         window.clear();
         draw();
         window.display();
+        PROFILE_FRAME();
     }
 }
 
 void Environment::update() {
+    PROFILE_ZONE("Update");
     float dt = clock.restart().asSeconds();
 
     gui.update();
 
-    for (auto* obj : rigidobjs) {
-        obj->applyForces(dt);
-    }
-    
-    for (size_t i = 0; i < rigidobjs.size(); i++) {
-        for (size_t j = i + 1; j < rigidobjs.size(); j++) {
-            auto* bodyA = rigidobjs[i];
-            auto* bodyB = rigidobjs[j];
-            
-            CollisionHandler::CollisionInfo info = CollisionHandler::detectCollision(bodyA, bodyB);
-            
-            if (info.hasCollision) {
-                CollisionHandler::resolveCollision(bodyA, bodyB, info);
-                std::cout << "Collision detected between objects " << i << " and " << j << std::endl;
-            }
-        }
-    }
-    
-    for (auto* obj : rigidobjs) {
-        obj->update(dt, window.getSize().x, window.getSize().y);
-    }
-    
-    for (auto it = liquidobjs.begin(); it != liquidobjs.end();) {
-        (*it)->update(dt, window.getSize().x, window.getSize().y);
-        
-        if ((*it)->isDead()) {
-            delete *it;
-            it = liquidobjs.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    
-    for (auto* particle : liquidobjs) {
-        for (auto* obj : rigidobjs) {
-            CollisionHandler::CollisionInfo info = CollisionHandler::detectCollision(particle, obj);
-            
-            if (info.hasCollision) {
-                CollisionHandler::resolveCollision(particle, obj, info);
-            }
-        }
-    }
+    world.advance(dt);
+    checkPendingSave();
+
+    updateStatsText();
+    profilerOverlay.update();
 }
 
 void Environment::draw() {
+    PROFILE_ZONE("Draw");
     sf::View currentView = window.getView();
     
     window.setView(mainView);
     
-    for (auto& body : rigidobjs) {
-        body->draw(window);
+    float alpha = world.getInterpolationAlpha();
+
+    if (world.areWallsEnabled()) {
+        const sf::FloatRect& bounds = world.getBounds();
+        sf::RectangleShape walls(sf::Vector2f(bounds.width, bounds.height));
+        walls.setPosition(bounds.left, bounds.top);
+        walls.setFillColor(sf::Color::Transparent);
+        walls.setOutlineColor(sf::Color(90, 90, 90));
+        walls.setOutlineThickness(2.0f / zoomLevel);
+        window.draw(walls);
+    }
+
+    AABB visible = visibleArea();
+    renderer.beginFrame();
+    {
+        PROFILE_ZONE("Draw bodies");
+        world.queryBodies(visible, visibleBodies);
+        renderer.drawBodies(window, world.getBodies(), visibleBodies, alpha);
     }
     
-    for (auto& particle : liquidobjs) {
-        particle->draw(window);
+    {
+        PROFILE_ZONE("Draw particles");
+        renderer.drawParticles(window, world.getParticles(), visible, alpha);
     }
+    PROFILE_COUNTER("draw calls", renderer.getDrawCalls());
 
     userInput.drawPreview(window);
     
@@ -556,6 +779,9 @@ void Environment::draw() {
     if (showProperties) {
         window.draw(propertiesPanel);
     }
+
+    window.draw(statsText);
+    profilerOverlay.draw(window);
     
     gui.draw(window);
     
@@ -563,33 +789,7 @@ void Environment::draw() {
 }
 
 void Environment::spawnLiquidObjects(const sf::Vector2f& position, int count) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<float> radiusDist(2.0f, 4.0f);
-    static std::uniform_real_distribution<float> velDist(-30.0f, 30.0f);
-    static std::uniform_real_distribution<float> lifetimeDist(3.0f, 7.0f);
-    
-    for (int i = 0; i < count; i++) {
-        float radius = radiusDist(gen);
-        float lifetime = lifetimeDist(gen);
-        
-        sf::Vector2f velocity(velDist(gen), velDist(gen) + 30.0f);
-        
-        sf::Color waterColor(40, 130, 255, 180); 
-        
-        LiquidParticle* particle = new LiquidParticle(
-            position,
-            radius,
-            velocity,
-            {0, 0},
-            waterColor,
-            0.8f,
-            lifetime
-        );
-        
-        particle->addForce(new Gravity(0, 1000.0f));
-        liquidobjs.push_back(particle);
-    }
+    world.spawnLiquidObjects(position, count);
 }
 
 void Environment::createRectangle(const sf::Vector2f& start, const sf::Vector2f& end) {
@@ -600,9 +800,8 @@ void Environment::createRectangle(const sf::Vector2f& start, const sf::Vector2f&
     vertices.push_back(end);
     vertices.push_back({start.x, end.y});
 
-    rigidobjs.push_back(new RigidBody(vertices, {0, 0}, {0, 0}, sf::Color::Red));
-    rigidobjs.back()->addForce(new Gravity(0, 1000.0f));
-    std::cout << "Rectangle created.\n";
+    placed(world.createPolygon(vertices, {0, 0}, placingColor(sf::Color::Red)));
+    LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Rectangle created";
 }
 
 void Environment::createTriangle(const sf::Vector2f& start, const sf::Vector2f& end) {
@@ -611,9 +810,20 @@ void Environment::createTriangle(const sf::Vector2f& start, const sf::Vector2f&
     vertices.push_back({start.x, end.y});
     vertices.push_back({end.x, end.y});
 
-    rigidobjs.push_back(new RigidBody(vertices, {0, 0}, {0, 0}, sf::Color::Green));
-    rigidobjs.back()->addForce(new Gravity(0, 1000.0f));
-    std::cout << "Triangle created.\n";
+    placed(world.createPolygon(vertices, {0, 0}, placingColor(sf::Color::Green)));
+    LOG(LogCategory::VIEWER, LogLevel::DEBUG) << "Triangle created";
+}
+
+void Environment::createCircle(const sf::Vector2f& center, float radius) {
+    placed(world.createCircle(center, radius, {0, 0}, placingColor(sf::Color::Blue)));
+}
+
+sf::Color Environment::placingColor(sf::Color dynamicColor) const {
+    return placeStatic ? sf::Color(140, 140, 140) : dynamicColor;
+}
+
+void Environment::placed(BodyHandle handle) {
+    if (placeStatic) world.setBodyType(handle, BodyType::STATIC);
 }
 
 std::string Environment::getShapeTypeName(ShapeType type) {
@@ -1,10 +1,45 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include "Forces.hpp"
-#include "PhysicsObject.hpp"
 
-Gravity::Gravity(float gx, float gy) : gravity(gx, gy) {}
+void ForceArena::add(std::uint32_t body, const ForceDef& force) {
+    entries.push_back({body, force, 0});
+}
+
+void ForceArena::addCustom(std::uint32_t body, std::unique_ptr<Forces> force) {
+    ForceDef def;
+    def.type = ForceType::CUSTOM;
+    entries.push_back({body, def, static_cast<std::uint32_t>(custom.size())});
+    custom.push_back(std::move(force));
+}
+
+void ForceArena::removeType(std::uint32_t body, ForceType type) {
+    removeIf([body, type](const Entry& e) { return e.body == body && e.force.type == type; });
+}
+
+void ForceArena::removeBody(std::uint32_t body) {
+    removeIf([body](const Entry& e) { return e.body == body; });
+}
 
+void ForceArena::clear() {
+    entries.clear();
+    custom.clear();
+}
 
-sf::Vector2f Gravity::computeForce(PhysicsObject& obj){
-    return obj.getMass() * gravity;
+// Keeps the survivors in order, so forces still sum in the order they were
+// added, and compacts the custom slots to match.
+template <typename Pred>
+void ForceArena::removeIf(Pred pred) {
+    entries.erase(std::remove_if(entries.begin(), entries.end(), pred), entries.end());
+    if (custom.empty()) {
+        return;
+    }
+    std::vector<std::unique_ptr<Forces>> kept;
+    for (Entry& e : entries) {
+        if (e.force.type == ForceType::CUSTOM) {
+            kept.push_back(std::move(custom[e.custom]));
+            e.custom = static_cast<std::uint32_t>(kept.size() - 1);
+        }
+    }
+    custom.swap(kept);
 }
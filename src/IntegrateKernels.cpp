@@ -0,0 +1,173 @@
+#include "IntegrateKernels.hpp"
+#include "CpuFeatures.hpp"
+#include "IntegrateLanes.hpp"
+#include <cstring>
+#if defined(PHYSICS_INTEGRATE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace IntegrateKernels {
+
+namespace {
+
+#if defined(PHYSICS_INTEGRATE_SSE)
+struct Sse {
+    using V = __m128;
+    static constexpr size_t WIDTH = 4;
+    static constexpr int ALL = 0xF;
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float x) { return _mm_set1_ps(x); }
+    static V zero() { return _mm_setzero_ps(); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V less(V a, V b) { return _mm_cmplt_ps(a, b); }
+    static V greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static V notEqual(V a, V b) { return _mm_cmpneq_ps(a, b); }
+    static V either(V a, V b) { return _mm_or_ps(a, b); }
+    static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static int bits(V mask) { return _mm_movemask_ps(mask); }
+    // Four consecutive AABBs to and from one register per field.
+    static void loadBoxes(const float* p, V& minX, V& minY, V& maxX, V& maxY) {
+        minX = _mm_loadu_ps(p);
+        minY = _mm_loadu_ps(p + 4);
+        maxX = _mm_loadu_ps(p + 8);
+        maxY = _mm_loadu_ps(p + 12);
+        _MM_TRANSPOSE4_PS(minX, minY, maxX, maxY);
+    }
+    static void storeBoxes(float* p, V minX, V minY, V maxX, V maxY) {
+        _MM_TRANSPOSE4_PS(minX, minY, maxX, maxY);
+        _mm_storeu_ps(p, minX);
+        _mm_storeu_ps(p + 4, minY);
+        _mm_storeu_ps(p + 8, maxX);
+        _mm_storeu_ps(p + 12, maxY);
+    }
+    static V mask(const std::uint8_t* p) {
+        std::int32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        __m128i zero = _mm_setzero_si128();
+        __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+        return _mm_castsi128_ps(_mm_cmpgt_epi32(wide, zero));
+    }
+};
+#endif
+
+}
+
+Kernel best() {
+    // Checked once: the CPU can't change under us.
+    static const Kernel kernel = available(Kernel::Avx2) ? Kernel::Avx2
+                               : available(Kernel::Sse) ? Kernel::Sse
+                               : Kernel::Scalar;
+    return kernel;
+}
+
+const char* name(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Sse: return "sse";
+        case Kernel::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+bool available(Kernel kernel) {
+    switch (kernel) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse: return true;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2: return cpuHasAvx2();
+#endif
+        case Kernel::Scalar: return true;
+        default: return false;
+    }
+}
+
+void accelerate(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float linearDt, float angularDt) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse:
+            accelerateLanes<Sse>(bodies, begin, end, linearDt, angularDt);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            accelerateAvx2(bodies, begin, end, linearDt, angularDt);
+            return;
+#endif
+        default:
+            accelerateScalar(bodies, begin, end, linearDt, angularDt);
+    }
+}
+
+void kick(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float dt) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse:
+            kickLanes<Sse>(bodies, begin, end, dt);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            kickAvx2(bodies, begin, end, dt);
+            return;
+#endif
+        default:
+            kickScalar(bodies, begin, end, dt);
+    }
+}
+
+void drift(Kernel kernel, const Bodies& bodies, size_t begin, size_t end, float dt) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse:
+            driftLanes<Sse>(bodies, begin, end, dt);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            driftAvx2(bodies, begin, end, dt);
+            return;
+#endif
+        default:
+            driftScalar(bodies, begin, end, dt);
+    }
+}
+
+void boundCircles(Kernel kernel, const Circles& circles, size_t begin, size_t end, const Bounds& bounds) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse:
+            boundCirclesLanes<Sse>(circles, begin, end, bounds);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            boundCirclesAvx2(circles, begin, end, bounds);
+            return;
+#endif
+        default:
+            boundCirclesScalar(circles, begin, end, bounds);
+    }
+}
+
+void integrateParticles(Kernel kernel, const Particles& particles, size_t begin, size_t end,
+                        const sf::Vector2f& gravity, float dt, const Walls& walls) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_INTEGRATE_SSE)
+        case Kernel::Sse:
+            particlesLanes<Sse>(particles, begin, end, gravity, dt, walls);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            integrateParticlesAvx2(particles, begin, end, gravity, dt, walls);
+            return;
+#endif
+        default:
+            particlesScalar(particles, begin, end, gravity, dt, walls);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// Built with AVX2 enabled, unlike the rest of the library; only reached
+// through IntegrateKernels' dispatch once the CPU is known to support it. Don't
+// call inline library functions here: an out-of-line copy compiled in this
+// file could be the one the linker keeps for every other caller.
+#include "IntegrateLanes.hpp"
+#include <immintrin.h>
+
+namespace IntegrateKernels {
+
+namespace {
+
+struct Avx2 {
+    using V = __m256;
+    static constexpr size_t WIDTH = 8;
+    static constexpr int ALL = 0xFF;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V zero() { return _mm256_setzero_ps(); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V notEqual(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    static V either(V a, V b) { return _mm256_or_ps(a, b); }
+    static V select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+    static int bits(V mask) { return _mm256_movemask_ps(mask); }
+    // Eight consecutive AABBs: box k in the low half of a row, box k + 4 in
+    // the high half, so the in-lane transpose leaves them in order.
+    static void loadBoxes(const float* p, V& minX, V& minY, V& maxX, V& maxY) {
+        V r0 = _mm256_loadu2_m128(p + 16, p);
+        V r1 = _mm256_loadu2_m128(p + 20, p + 4);
+        V r2 = _mm256_loadu2_m128(p + 24, p + 8);
+        V r3 = _mm256_loadu2_m128(p + 28, p + 12);
+        transpose(r0, r1, r2, r3);
+        minX = r0;
+        minY = r1;
+        maxX = r2;
+        maxY = r3;
+    }
+    static void storeBoxes(float* p, V minX, V minY, V maxX, V maxY) {
+        transpose(minX, minY, maxX, maxY);
+        _mm256_storeu2_m128(p + 16, p, minX);
+        _mm256_storeu2_m128(p + 20, p + 4, minY);
+        _mm256_storeu2_m128(p + 24, p + 8, maxX);
+        _mm256_storeu2_m128(p + 28, p + 12, maxY);
+    }
+    static void transpose(V& r0, V& r1, V& r2, V& r3) {
+        V t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpacklo_ps(r2, r3);
+        V t2 = _mm256_unpackhi_ps(r0, r1), t3 = _mm256_unpackhi_ps(r2, r3);
+        r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    static V mask(const std::uint8_t* p) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        __m256i wide = _mm256_cvtepu8_epi32(bytes);
+        return _mm256_castsi256_ps(_mm256_cmpgt_epi32(wide, _mm256_setzero_si256()));
+    }
+};
+
+}
+
+void accelerateAvx2(const Bodies& bodies, size_t begin, size_t end, float linearDt, float angularDt) {
+    accelerateLanes<Avx2>(bodies, begin, end, linearDt, angularDt);
+}
+
+void kickAvx2(const Bodies& bodies, size_t begin, size_t end, float dt) {
+    kickLanes<Avx2>(bodies, begin, end, dt);
+}
+
+void driftAvx2(const Bodies& bodies, size_t begin, size_t end, float dt) {
+    driftLanes<Avx2>(bodies, begin, end, dt);
+}
+
+void boundCirclesAvx2(const Circles& circles, size_t begin, size_t end, const Bounds& bounds) {
+    boundCirclesLanes<Avx2>(circles, begin, end, bounds);
+}
+
+void integrateParticlesAvx2(const Particles& particles, size_t begin, size_t end,
+                            const sf::Vector2f& gravity, float dt, const Walls& walls) {
+    particlesLanes<Avx2>(particles, begin, end, gravity, dt, walls);
+}
+
+}
@@ -0,0 +1,153 @@
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+Logger& Logger::get() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : output(&std::cout) {
+    for (size_t i = 0; i < CAPACITY; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    worker = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running = false;
+    }
+    wake.notify_one();
+    worker.join();
+    drain();
+}
+
+void Logger::setCategoryEnabled(LogCategory category, bool enabled) {
+    uint32_t bit = 1u << static_cast<uint32_t>(category);
+    if (enabled) {
+        enabledCategories.fetch_or(bit);
+    } else {
+        enabledCategories.fetch_and(~bit);
+    }
+}
+
+bool Logger::isEnabled(LogCategory category, LogLevel level) const {
+    return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed) &&
+           (enabledCategories.load(std::memory_order_relaxed) & (1u << static_cast<uint32_t>(category)));
+}
+
+void Logger::log(LogCategory category, LogLevel level, const char* text, size_t length) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos % CAPACITY];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The drain thread hasn't freed this slot yet: the queue is full.
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->category = category;
+    slot->level = level;
+    slot->length = static_cast<uint16_t>(std::min(length, MAX_MESSAGE));
+    std::memcpy(slot->text, text, slot->length);
+    // Sequentially consistent, like the drain thread's side in run(): either
+    // it sees this slot before it sleeps, or we see it waiting.
+    slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+}
+
+void Logger::setOutput(std::ostream& stream) {
+    flush();
+    std::lock_guard<std::mutex> lock(outputMutex);
+    output = &stream;
+}
+
+bool Logger::pop(Slot*& slot) {
+    Slot* candidate = &slots[dequeuePos % CAPACITY];
+    if (candidate->sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+        return false;
+    }
+    slot = candidate;
+    return true;
+}
+
+bool Logger::hasPending() const {
+    return slots[dequeuePos % CAPACITY].sequence.load(std::memory_order_seq_cst) == dequeuePos + 1;
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    Slot* slot;
+    bool any = false;
+    while (pop(slot)) {
+        *output << '[' << levelName(slot->level) << "][" << categoryName(slot->category) << "] ";
+        output->write(slot->text, slot->length);
+        *output << '\n';
+
+        slot->sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        dequeuePos++;
+        written.fetch_add(1, std::memory_order_release);
+        any = true;
+    }
+    if (any) {
+        output->flush();
+    }
+}
+
+void Logger::run() {
+    while (running) {
+        drain();
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        drained.notify_all();
+        waiting.store(true, std::memory_order_seq_cst);
+        wake.wait(lock, [this] { return hasPending() || !running; });
+        waiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::flush() {
+    size_t target = enqueuePos.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    drained.wait(lock, [this, target] { return written.load(std::memory_order_acquire) >= target || !running; });
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO: return "info";
+        case LogLevel::WARNING: return "warning";
+        case LogLevel::ERROR: return "error";
+        default: return "?";
+    }
+}
+
+const char* Logger::categoryName(LogCategory category) {
+    switch (category) {
+        case LogCategory::WORLD: return "world";
+        case LogCategory::VIEWER: return "viewer";
+        case LogCategory::PROFILER: return "profiler";
+        default: return "?";
+    }
+}
+
+LogLine::~LogLine() {
+    const std::string text = stream.str();
+    Logger::get().log(category, level, text.data(), text.size());
+}
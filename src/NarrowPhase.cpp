@@ -0,0 +1,43 @@
+#include "NarrowPhase.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+void NarrowPhase::run(BodyStore& bodies, const std::vector<BroadPhase::Pair>& pairs,
+                      ThreadPool& pool, std::vector<CollisionHandler::Contact>& contacts) {
+    // World vertices are built on demand; bring the ones these pairs read up
+    // to date before the threads share them.
+    for (const BroadPhase::Pair& pair : pairs) {
+        bodies.refreshVertices(pair.first);
+        bodies.refreshVertices(pair.second);
+    }
+
+    threadContacts.resize(pool.size());
+    for (auto& buffer : threadContacts) {
+        buffer.clear();
+    }
+
+    pool.parallelFor(pairs.size(), 64, [&](size_t begin, size_t end, size_t slot) {
+        PROFILE_ZONE("Narrow phase batch");
+        std::vector<CollisionHandler::Contact>& buffer = threadContacts[slot];
+        for (size_t k = begin; k < end; k++) {
+            size_t a = pairs[k].first;
+            size_t b = pairs[k].second;
+            // The solver moves only the first body of a contact with a
+            // static or kinematic one.
+            if (bodies.type[a] != BodyType::DYNAMIC) {
+                std::swap(a, b);
+            }
+            CollisionHandler::CollisionInfo info = CollisionHandler::detectCollision(
+                CollisionHandler::bodyShape(bodies, a), CollisionHandler::bodyShape(bodies, b));
+            if (info.hasCollision) {
+                buffer.push_back({a, b, info});
+            }
+        }
+    });
+
+    contacts.clear();
+    for (const auto& buffer : threadContacts) {
+        contacts.insert(contacts.end(), buffer.begin(), buffer.end());
+    }
+    std::sort(contacts.begin(), contacts.end());
+}
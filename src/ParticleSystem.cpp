@@ -0,0 +1,267 @@
+#include "ParticleSystem.hpp"
+#include "IntegrateKernels.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float PI = 3.14159f;
+const size_t INTEGRATE_GRAIN = 16384;
+const int MAX_GRID_SIDE = 1024;
+
+// Cell coordinate along one axis, kept well inside int range so the grid
+// arithmetic can't overflow whatever a particle's position.
+int cellCoord(float v, float h) {
+    return static_cast<int>(std::min(1e8f, std::max(-1e8f, std::floor(v / h))));
+}
+
+// std::uniform_real_distribution is implemented differently by each
+// standard library; mt19937's raw output is fixed by the standard, so map
+// that ourselves to get the same particles everywhere.
+float uniform(std::mt19937& rng, float lo, float hi) {
+    return lo + (hi - lo) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+}
+
+}
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : gravity(0.0f, 1000.0f), color(40, 130, 255, 180), particleDensity(0.8f) {
+    setCapacity(capacity);
+}
+
+void ParticleSystem::setCapacity(size_t capacity) {
+    capacity = std::min(capacity, MAX_CAPACITY);
+    count = std::min(count, capacity);
+    posX.resize(capacity);
+    posY.resize(capacity);
+    prevX.resize(capacity);
+    prevY.resize(capacity);
+    velX.resize(capacity);
+    velY.resize(capacity);
+    radius.resize(capacity);
+    mass.resize(capacity);
+    invMass.resize(capacity);
+    age.resize(capacity);
+    lifetime.resize(capacity);
+    density.resize(capacity);
+    pressure.resize(capacity);
+    accX.resize(capacity);
+    accY.resize(capacity);
+    particleCell.resize(capacity);
+    cellParticles.resize(capacity);
+}
+
+size_t ParticleSystem::spawn(const sf::Vector2f& position, size_t requested, std::mt19937& rng) {
+    size_t first = count;
+    size_t last = std::min(count + requested, capacity());
+
+    for (size_t i = first; i < last; i++) {
+        float r = uniform(rng, 2.0f, 4.0f);
+        // Coincident particles have no pressure gradient between them, so
+        // spread the burst slightly.
+        posX[i] = prevX[i] = position.x + uniform(rng, -2.0f, 2.0f);
+        posY[i] = prevY[i] = position.y + uniform(rng, -2.0f, 2.0f);
+        velX[i] = uniform(rng, -30.0f, 30.0f);
+        velY[i] = uniform(rng, -30.0f, 30.0f) + 30.0f;
+        radius[i] = r;
+        mass[i] = particleDensity * PI * r * r;
+        invMass[i] = 1.0f / mass[i];
+        age[i] = 0.0f;
+        lifetime[i] = uniform(rng, 3.0f, 7.0f);
+    }
+
+    count = last;
+    return last - first;
+}
+
+void ParticleSystem::retire(size_t i) {
+    size_t back = count - 1;
+    posX[i] = posX[back];
+    posY[i] = posY[back];
+    prevX[i] = prevX[back];
+    prevY[i] = prevY[back];
+    velX[i] = velX[back];
+    velY[i] = velY[back];
+    radius[i] = radius[back];
+    mass[i] = mass[back];
+    invMass[i] = invMass[back];
+    age[i] = age[back];
+    lifetime[i] = lifetime[back];
+    count--;
+}
+
+void ParticleSystem::update(float dt, const IntegrateKernels::Bounds& bounds) {
+    for (size_t i = 0; i < count; i++) {
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+        age[i] += dt;
+    }
+
+    int substeps = 1;
+    if (model == LiquidModel::SPH && count > 0) {
+        // Keep each substep under the CFL limit for the pressure wave speed.
+        float soundSpeed = std::sqrt(sph.stiffness / sph.restDensity);
+        float maxDt = 0.4f * sph.kernelRadius / soundSpeed;
+        substeps = std::min(8, std::max(1, static_cast<int>(std::ceil(dt / maxDt))));
+    }
+
+    float subDt = dt / substeps;
+    for (int step = 0; step < substeps; step++) {
+        if (model == LiquidModel::SPH) {
+            PROFILE_ZONE("SPH");
+            buildGrid();
+            computeSPH();
+        } else {
+            std::fill(accX.begin(), accX.begin() + count, 0.0f);
+            std::fill(accY.begin(), accY.begin() + count, 0.0f);
+        }
+        integrate(subDt, bounds);
+    }
+
+    // Walk backwards so the particle swapped into slot i has already been checked.
+    for (size_t i = count; i-- > 0;) {
+        if (age[i] >= lifetime[i]) {
+            retire(i);
+        }
+    }
+}
+
+void ParticleSystem::integrate(float dt, const IntegrateKernels::Bounds& bounds) {
+    IntegrateKernels::Particles arrays{posX.data(), posY.data(), velX.data(), velY.data(),
+                                      accX.data(), accY.data(), radius.data()};
+    IntegrateKernels::Walls walls{bounds, 0.2f, 0.95f};
+    IntegrateKernels::Kernel kernel = IntegrateKernels::best();
+
+    // Bandwidth-bound, so only worth splitting in big chunks.
+    if (pool && count > INTEGRATE_GRAIN) {
+        pool->parallelFor(count, INTEGRATE_GRAIN, [&](size_t begin, size_t end, size_t) {
+            IntegrateKernels::integrateParticles(kernel, arrays, begin, end, gravity, dt, walls);
+        });
+    } else {
+        IntegrateKernels::integrateParticles(kernel, arrays, 0, count, gravity, dt, walls);
+    }
+}
+
+void ParticleSystem::buildGrid() {
+    float h = sph.kernelRadius;
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    if (count > 0) {
+        minX = maxX = posX[0];
+        minY = maxY = posY[0];
+    }
+    for (size_t i = 1; i < count; i++) {
+        minX = std::min(minX, posX[i]);
+        maxX = std::max(maxX, posX[i]);
+        minY = std::min(minY, posY[i]);
+        maxY = std::max(maxY, posY[i]);
+    }
+    // A few stray particles far from the rest must not blow up the grid.
+    // Particles beyond the cap share the edge cells, which only costs extra
+    // distance tests: clamping never moves two neighbours further apart
+    // than adjacent cells.
+    int gridX = cellCoord(minX, h);
+    int gridY = cellCoord(minY, h);
+    gridWidth = std::min(MAX_GRID_SIDE, cellCoord(maxX, h) - gridX + 1);
+    gridHeight = std::min(MAX_GRID_SIDE, cellCoord(maxY, h) - gridY + 1);
+    size_t cellCount = static_cast<size_t>(gridWidth) * gridHeight;
+
+    cellStart.assign(cellCount + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        int cx = std::min(gridWidth - 1, std::max(0, cellCoord(posX[i], h) - gridX));
+        int cy = std::min(gridHeight - 1, std::max(0, cellCoord(posY[i], h) - gridY));
+        particleCell[i] = cy * gridWidth + cx;
+        cellStart[particleCell[i] + 1]++;
+    }
+
+    for (size_t c = 0; c < cellCount; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    // Counting sort: particles of cell c end up in cellParticles[cellStart[c], cellStart[c + 1]).
+    cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        cellParticles[cellFill[particleCell[i]]++] = i;
+    }
+}
+
+template<typename Fn>
+void ParticleSystem::forEachNeighbour(size_t i, Fn fn) const {
+    int cx = particleCell[i] % gridWidth;
+    int cy = particleCell[i] / gridWidth;
+    for (int y = std::max(0, cy - 1); y <= std::min(gridHeight - 1, cy + 1); y++) {
+        for (int x = std::max(0, cx - 1); x <= std::min(gridWidth - 1, cx + 1); x++) {
+            int cell = y * gridWidth + x;
+            for (size_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                fn(cellParticles[k]);
+            }
+        }
+    }
+}
+
+void ParticleSystem::computeSPH() {
+    const float h = sph.kernelRadius;
+    const float h2 = h * h;
+    const float poly6 = 4.0f / (PI * std::pow(h, 8.0f));
+    const float spikyGrad = -30.0f / (PI * std::pow(h, 5.0f));
+    const float viscLaplacian = 40.0f / (PI * std::pow(h, 5.0f));
+
+    // Each pass only writes to slot i, so particles can be split across threads.
+    auto forEachParticle = [this](const std::function<void(size_t)>& fn) {
+        if (pool) {
+            pool->parallelFor(count, 256, [&fn](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; i++) fn(i);
+            });
+        } else {
+            for (size_t i = 0; i < count; i++) fn(i);
+        }
+    };
+
+    forEachParticle([&](size_t i) {
+        float rho = 0.0f;
+        forEachNeighbour(i, [&](size_t j) {
+            float dx = posX[i] - posX[j];
+            float dy = posY[i] - posY[j];
+            float r2 = dx * dx + dy * dy;
+            if (r2 < h2) {
+                float diff = h2 - r2;
+                rho += mass[j] * poly6 * diff * diff * diff;
+            }
+        });
+        density[i] = rho;
+        // No negative pressure: it makes free surfaces clump together.
+        pressure[i] = std::max(0.0f, sph.stiffness * (rho - sph.restDensity));
+    });
+
+    forEachParticle([&](size_t i) {
+        float ax = 0.0f, ay = 0.0f;
+        forEachNeighbour(i, [&](size_t j) {
+            if (j == i) return;
+            float dx = posX[i] - posX[j];
+            float dy = posY[i] - posY[j];
+            float r2 = dx * dx + dy * dy;
+            if (r2 >= h2) return;
+
+            float r = std::sqrt(r2);
+            float w = h - r;
+            if (r > 1e-4f) {
+                float shared = mass[j] * (pressure[i] + pressure[j]) / (2.0f * density[j]) * spikyGrad * w * w / r;
+                ax -= shared * dx;
+                ay -= shared * dy;
+            }
+
+            float visc = sph.viscosity * mass[j] / density[j] * viscLaplacian * w;
+            ax += visc * (velX[j] - velX[i]);
+            ay += visc * (velY[j] - velY[i]);
+        });
+        accX[i] = ax / density[i];
+        accY[i] = ay / density[i];
+    });
+}
+
+AABB ParticleSystem::getAABB(size_t i) const {
+    AABB box;
+    box.min = sf::Vector2f(posX[i] - radius[i], posY[i] - radius[i]);
+    box.max = sf::Vector2f(posX[i] + radius[i], posY[i] + radius[i]);
+    return box;
+}
@@ -0,0 +1,945 @@
+#include "PhysicsWorld.hpp"
+#include "CollisionHandler.hpp"
+#include "Logger.hpp"
+#include "Profiler.hpp"
+#include "Recorder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+using StepClock = std::chrono::steady_clock;
+
+// Bodies per integration task: small enough that a chunk's arrays stay in
+// cache between the passes over it.
+const size_t INTEGRATE_GRAIN = 1024;
+
+double elapsedMs(StepClock::time_point& since) {
+    StepClock::time_point now = StepClock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - since).count();
+    since = now;
+    return ms;
+}
+
+const std::uint64_t fnvOffset = 14695981039346656037ull;
+const std::uint64_t fnvPrime = 1099511628211ull;
+
+void hashBits(std::uint64_t& hash, std::uint32_t bits) {
+    for (int b = 0; b < 4; b++) {
+        hash = (hash ^ ((bits >> (8 * b)) & 0xFFu)) * fnvPrime;
+    }
+}
+
+// Whether body i can change its contacts this step. A kinematic body at rest
+// can't, so it doesn't keep what sleeps against it awake.
+bool inMotion(const BodyStore& bodies, size_t i) {
+    if (!bodies.awake[i]) return false;
+    if (bodies.type[i] != BodyType::KINEMATIC) return true;
+    return bodies.velX[i] != 0.0f || bodies.velY[i] != 0.0f || bodies.angularVel[i] != 0.0f;
+}
+
+void hashFloats(std::uint64_t& hash, const std::vector<float>& values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        hashBits(hash, bits);
+    }
+}
+
+}
+
+PhysicsWorld::PhysicsWorld(float width, float height)
+    : bounds(0.0f, 0.0f, width, height), gravity(0.0f, 1000.0f),
+      pool(new ThreadPool()),
+      broadPhase(new SweepAndPrune()) {
+    particles.setGravity(gravity);
+    particles.setThreadPool(pool.get());
+}
+
+PhysicsWorld::~PhysicsWorld() {
+    clear();
+}
+
+int PhysicsWorld::advance(float frameTime) {
+    accumulator += frameTime;
+
+    int steps = 0;
+    while (accumulator >= fixedDt && steps < maxSubSteps) {
+        step(fixedDt);
+        accumulator -= fixedDt;
+        steps++;
+    }
+
+    if (steps == maxSubSteps && accumulator >= fixedDt) {
+        accumulator = 0.0f;
+    }
+    return steps;
+}
+
+void PhysicsWorld::setStepRate(float stepsPerSecond) {
+    if (!(stepsPerSecond > 0.0f) || !std::isfinite(stepsPerSecond)) {
+        LOG(LogCategory::WORLD, LogLevel::WARNING) << "Ignored step rate " << stepsPerSecond;
+        return;
+    }
+    if (recorder) recorder->recordStepRate(stepsPerSecond);
+    fixedDt = 1.0f / stepsPerSecond;
+}
+
+void PhysicsWorld::setDeterministic(bool enabled) {
+    if (recorder) recorder->recordDeterministic(enabled);
+    deterministic = enabled;
+}
+
+void PhysicsWorld::setSeed(std::uint32_t s) {
+    if (recorder) recorder->recordSeed(s);
+    seed = s;
+    rng.seed(s);
+}
+
+void PhysicsWorld::setRecorder(Recorder* r) {
+    recorder = r;
+    bodies.recorder = r;
+}
+
+void PhysicsWorld::step(float dt) {
+    PROFILE_ZONE("Step");
+    if (deterministic) {
+        dt = fixedDt;
+    }
+    collisionStats = CollisionStats();
+    StepClock::time_point timer = StepClock::now();
+
+    {
+        PROFILE_ZONE("Forces");
+        refreshBodyLists();
+        for (const std::pair<size_t, size_t>& range : movableRanges) {
+            std::copy(bodies.posX.begin() + range.first, bodies.posX.begin() + range.second, bodies.prevX.begin() + range.first);
+            std::copy(bodies.posY.begin() + range.first, bodies.posY.begin() + range.second, bodies.prevY.begin() + range.first);
+            std::copy(bodies.angle.begin() + range.first, bodies.angle.begin() + range.second, bodies.prevAngle.begin() + range.first);
+        }
+
+        applyForces();
+        integrateVelocities(dt);
+    }
+    stepTimings.forces = elapsedMs(timer);
+
+    {
+        PROFILE_ZONE("Broad phase");
+        buildBroadPhase();
+        broadPhase->findPairs(candidatePairs);
+        if (staticTree.size() > 0) {
+            // The mapping is increasing, so the pairs stay ordered.
+            for (BroadPhase::Pair& pair : candidatePairs) {
+                pair = BroadPhase::Pair(movableIndices[pair.first], movableIndices[pair.second]);
+            }
+        }
+
+        // Two bodies still asleep after the wake can't have changed contact
+        // since they fell asleep, and two kinematic ones don't respond to
+        // contact at all.
+        wakeTouchedIslands();
+        candidatePairs.erase(
+            std::remove_if(candidatePairs.begin(), candidatePairs.end(),
+                [this](const BroadPhase::Pair& pair) {
+                    if (bodies.type[pair.first] != BodyType::DYNAMIC && bodies.type[pair.second] != BodyType::DYNAMIC) {
+                        return true;
+                    }
+                    return !inMotion(bodies, pair.first) && !inMotion(bodies, pair.second);
+                }),
+            candidatePairs.end()
+        );
+        findStaticPairs();
+        collisionStats.candidatePairs = candidatePairs.size();
+    }
+    stepTimings.broadPhase = elapsedMs(timer);
+
+    {
+        PROFILE_ZONE("Narrow phase");
+        narrowPhase.run(bodies, candidatePairs, *pool, contacts);
+        collisionStats.contacts = contacts.size();
+        addWallContacts();
+    }
+    stepTimings.narrowPhase = elapsedMs(timer);
+
+    {
+        PROFILE_ZONE("Solve");
+        wakeContactIslands();
+
+        solver.solve(bodies, contacts, dt, *pool);
+        collisionStats.islands = solver.getIslandCount();
+        collisionStats.warmStartedPoints = solver.getWarmStartedPoints();
+    }
+    stepTimings.solve = elapsedMs(timer);
+    
+    {
+        PROFILE_ZONE("Integrate");
+        integrateBodies(dt);
+        updateSleep(dt);
+
+        if (integrationScheme == IntegrationScheme::VELOCITY_VERLET) {
+            // Second half kick, with forces at the new positions.
+            applyForces();
+            IntegrateKernels::Bodies arrays = bodyArrays(bodies.awake.data());
+            forMovableRanges([&](size_t begin, size_t end, size_t) {
+                IntegrateKernels::kick(IntegrateKernels::best(), arrays, begin, end, 0.5f * dt);
+            });
+        }
+    }
+    stepTimings.integrate = elapsedMs(timer);
+    
+    {
+        PROFILE_ZONE("Particles");
+        particles.update(dt, wallBounds());
+    
+        // Bodies moved during integration, so rebuild before querying
+        // particles. This build also serves queryBodies until the next step.
+        buildBroadPhase();
+        broadPhaseStale = false;
+
+        for (size_t p = 0; p < particles.size(); p++) {
+            queryMovable(particles.getAABB(p), queryResults);
+            queryStatics(particles.getAABB(p), queryResults, staticHits);
+            collisionStats.particleCandidates += queryResults.size();
+
+            for (size_t idx : queryResults) {
+                bodies.refreshVertices(idx);
+                CollisionHandler::CollisionInfo info = CollisionHandler::detectCollision(
+                    CollisionHandler::particleShape(particles, p), CollisionHandler::bodyShape(bodies, idx));
+            
+                if (info.hasCollision) {
+                    CollisionHandler::resolveCollision(particles, p, bodies, idx, info);
+                    collisionStats.particleContacts++;
+                }
+            }
+        }
+    }
+    stepTimings.particles = elapsedMs(timer);
+
+    stepCount++;
+    if (deterministic) {
+        stepHash = computeStateHash();
+    }
+    if (recorder) {
+        recorder->stepEnded();
+    }
+
+    PROFILE_COUNTER("pairs", collisionStats.candidatePairs);
+    PROFILE_COUNTER("contacts", collisionStats.contacts);
+    PROFILE_COUNTER("particle contacts", collisionStats.particleContacts);
+}
+
+std::uint64_t PhysicsWorld::computeStateHash() const {
+    std::uint64_t hash = fnvOffset;
+    size_t n = bodies.size();
+    hashBits(hash, static_cast<std::uint32_t>(n));
+
+    // Between a change to the body set and the next step the lists are out
+    // of date; work from the types then.
+    bool listsCurrent = !movableStale && staticTreeRevision == bodies.getStaticRevision();
+    std::vector<size_t> scanned;
+    if (!listsCurrent) {
+        for (size_t i = 0; i < n; i++) {
+            if (bodies.type[i] != BodyType::STATIC) scanned.push_back(i);
+        }
+    }
+    const std::vector<size_t>& movable = listsCurrent ? movableIndices : scanned;
+
+    // Without statics this is every body in dense order.
+    for (const std::vector<float>* field : {&bodies.posX, &bodies.posY, &bodies.angle,
+                                            &bodies.velX, &bodies.velY, &bodies.angularVel}) {
+        for (size_t i : movable) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &(*field)[i], sizeof(bits));
+            hashBits(hash, bits);
+        }
+    }
+    for (size_t i : movable) {
+        hashBits(hash, bodies.awake[i]);
+    }
+
+    // Statics only change through calls that bump the static revision, and
+    // removing other bodies shifts their indices but not their ids, so their
+    // share is hashed in id order once per revision.
+    if (movable.size() < n) {
+        if (staticHashRevision != bodies.getStaticRevision()) {
+            std::vector<std::pair<std::uint32_t, size_t>> statics;
+            for (size_t i = 0; i < n; i++) {
+                if (bodies.type[i] == BodyType::STATIC) statics.emplace_back(bodies.handleAt(i).id, i);
+            }
+            std::sort(statics.begin(), statics.end());
+            staticHash = fnvOffset;
+            for (const std::pair<std::uint32_t, size_t>& entry : statics) {
+                hashBits(staticHash, entry.first);
+                for (const std::vector<float>* field : {&bodies.posX, &bodies.posY, &bodies.angle}) {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, &(*field)[entry.second], sizeof(bits));
+                    hashBits(staticHash, bits);
+                }
+            }
+            staticHashRevision = bodies.getStaticRevision();
+        }
+        hashBits(hash, static_cast<std::uint32_t>(staticHash));
+        hashBits(hash, static_cast<std::uint32_t>(staticHash >> 32));
+    }
+
+    size_t p = particles.size();
+    hashBits(hash, static_cast<std::uint32_t>(p));
+    for (const std::vector<float>* field : {&particles.posX, &particles.posY, &particles.velX, &particles.velY}) {
+        hashFloats(hash, *field, p);
+    }
+    return hash;
+}
+
+void PhysicsWorld::applyForces() {
+    // Gravity is a field: one acceleration for every body, no per-body lookup.
+    for (size_t i : movableIndices) {
+        if (!bodies.awake[i] || bodies.mass[i] <= 0) continue;
+        bodies.accX[i] = gravity.x;
+        bodies.accY[i] = gravity.y;
+    }
+
+    // Per-body forces, in the order they were added. Only CUSTOM ones cost a
+    // virtual call.
+    for (const ForceArena::Entry& entry : bodies.forces.getEntries()) {
+        size_t i = bodies.indexOfId(entry.body);
+        if (!bodies.awake[i] || bodies.mass[i] <= 0) continue;
+
+        const ForceDef& f = entry.force;
+        sf::Vector2f acceleration;
+        switch (f.type) {
+            case ForceType::GRAVITY:
+                acceleration = f.vector;
+                break;
+            case ForceType::DRAG:
+                acceleration = bodies.velocity(i) * (-f.coefficient * bodies.invMass[i]);
+                break;
+            case ForceType::SPRING:
+                acceleration = ((f.vector - bodies.position(i)) * f.coefficient - bodies.velocity(i) * f.damping) *
+                               bodies.invMass[i];
+                break;
+            case ForceType::CUSTOM:
+                acceleration = bodies.forces.getCustom(entry.custom).computeForce(
+                    bodies.mass[i], bodies.position(i), bodies.velocity(i)) * bodies.invMass[i];
+                break;
+        }
+        bodies.accX[i] += acceleration.x;
+        bodies.accY[i] += acceleration.y;
+    }
+}
+
+IntegrateKernels::Bodies PhysicsWorld::bodyArrays(const std::uint8_t* mask) {
+    return {mask, bodies.posX.data(), bodies.posY.data(), bodies.angle.data(),
+            bodies.velX.data(), bodies.velY.data(), bodies.angularVel.data(),
+            bodies.accX.data(), bodies.accY.data(), bodies.torque.data(), bodies.invInertia.data()};
+}
+
+void PhysicsWorld::integrateVelocities(float dt) {
+    // Verlet takes half the kick now and half after the drift; torque is
+    // applied whole either way.
+    float linearDt = integrationScheme == IntegrationScheme::VELOCITY_VERLET ? 0.5f * dt : dt;
+    IntegrateKernels::Kernel kernel = IntegrateKernels::best();
+    IntegrateKernels::Bodies arrays = bodyArrays(bodies.awake.data());
+    forMovableRanges([&](size_t begin, size_t end, size_t) {
+        IntegrateKernels::accelerate(kernel, arrays, begin, end, linearDt, dt);
+    });
+}
+
+void PhysicsWorld::integrateBodies(float dt) {
+    size_t n = bodies.size();
+    moveMask.resize(n);
+    circleMask.resize(n);
+
+    bulletIndices.clear();
+    if (continuousCollision) {
+        for (size_t i : movableIndices) {
+            if (bodies.awake[i] && bodies.bullet[i] && bodies.type[i] == BodyType::DYNAMIC) bulletIndices.push_back(i);
+        }
+    }
+
+    static_assert(sizeof(AABB) == 4 * sizeof(float), "boundCircles reads AABBs as four floats");
+    IntegrateKernels::Kernel kernel = IntegrateKernels::best();
+    IntegrateKernels::Bodies arrays = bodyArrays(moveMask.data());
+    IntegrateKernels::Circles circles{circleMask.data(), bodies.posX.data(), bodies.posY.data(),
+                                      bodies.radius.data(), reinterpret_cast<float*>(bodies.aabbs.data())};
+    IntegrateKernels::Bounds walls = wallBounds();
+
+    // Every pass over a chunk before moving to the next, so the chunk's
+    // arrays stay in cache. Each body only touches its own entries.
+    forMovableRanges([&](size_t begin, size_t end, size_t) {
+        const std::uint8_t* awake = bodies.awake.data();
+        const std::uint8_t* bullet = bodies.bullet.data();
+        const BodyShape* shape = bodies.shape.data();
+        const BodyType* type = bodies.type.data();
+        std::uint8_t* move = moveMask.data();
+        std::uint8_t* circle = circleMask.data();
+        bool swept = continuousCollision;
+        for (size_t i = begin; i < end; i++) {
+            bool dynamic = type[i] == BodyType::DYNAMIC;
+            move[i] = awake[i] && !(swept && dynamic && bullet[i]);
+            circle[i] = move[i] && dynamic && shape[i] == BodyShape::CIRCLE;
+        }
+        IntegrateKernels::drift(kernel, arrays, begin, end, dt);
+        // Circles have no vertices to mark stale, and their bounds and the
+        // clamp vectorize.
+        IntegrateKernels::boundCircles(kernel, circles, begin, end, walls);
+        // A polygon's new AABB costs a sin and cos. Kinematic bodies of
+        // either shape land here too; the walls don't hold them.
+        for (size_t i = begin; i < end; i++) {
+            if (!moveMask[i] || circleMask[i]) continue;
+            bodies.poseChanged(i);
+            if (type[i] == BodyType::DYNAMIC) clampToBounds(i);
+        }
+    });
+
+    if (!bulletIndices.empty()) {
+        // Sweep bullets against where everything else ended up this step.
+        buildBroadPhase();
+        for (size_t i : bulletIndices) {
+            advanceBullet(i, dt);
+        }
+    }
+}
+
+IntegrateKernels::Bounds PhysicsWorld::wallBounds() const {
+    if (!wallsEnabled) {
+        const float far = std::numeric_limits<float>::infinity();
+        return {-far, -far, far, far};
+    }
+    return {bounds.left, bounds.top, bounds.left + bounds.width, bounds.top + bounds.height};
+}
+
+void PhysicsWorld::clampToBounds(size_t i) {
+    // Only a positional safety net: the walls' impulses, friction included,
+    // come from the contacts addWallContacts hands to the solver.
+    if (!wallsEnabled) return;
+    const AABB& box = bodies.aabbs[i];
+    float right = bounds.left + bounds.width;
+    float bottom = bounds.top + bounds.height;
+    float adjustX = 0, adjustY = 0;
+
+    if (box.min.x < bounds.left) adjustX = bounds.left - box.min.x;
+    else if (box.max.x > right) adjustX = right - box.max.x;
+
+    if (box.min.y < bounds.top) adjustY = bounds.top - box.min.y;
+    else if (box.max.y > bottom) adjustY = bottom - box.max.y;
+
+    if (adjustX != 0 || adjustY != 0) {
+        // The box moves with the body, so there's no need to recompute it.
+        bodies.posX[i] += adjustX;
+        bodies.posY[i] += adjustY;
+        bodies.aabbs[i].min += sf::Vector2f(adjustX, adjustY);
+        bodies.aabbs[i].max += sf::Vector2f(adjustX, adjustY);
+    }
+}
+
+void PhysicsWorld::addWallContacts() {
+    if (!wallsEnabled) return;
+    // The clamp leaves resting bodies exactly on the wall; the margin keeps
+    // them from losing the contact every other step.
+    const float margin = CollisionHandler::CONTACT_MARGIN;
+    const sf::Vector2f walls[4] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    // Distance of each wall along its outward normal, from the origin.
+    const float wallOffsets[4] = {-bounds.left, bounds.left + bounds.width, -bounds.top, bounds.top + bounds.height};
+
+    for (size_t i : movableIndices) {
+        if (!bodies.awake[i] || bodies.type[i] != BodyType::DYNAMIC) continue;
+
+        const AABB& box = bodies.aabbs[i];
+        for (std::uint32_t wall = 0; wall < 4; wall++) {
+            const sf::Vector2f& normal = walls[wall];
+            float wallOffset = wallOffsets[wall];
+            float reach = normal.x != 0 ? (normal.x > 0 ? box.max.x : -box.min.x)
+                                        : (normal.y > 0 ? box.max.y : -box.min.y);
+            if (reach - wallOffset < -margin) continue;
+
+            CollisionHandler::Contact contact;
+            contact.bodyA = i;
+            contact.bodyB = CollisionHandler::WORLD;
+            contact.wall = wall;
+            contact.info.hasCollision = true;
+            contact.info.normal = normal;
+
+            CollisionHandler::CollisionInfo& info = contact.info;
+            if (bodies.shape[i] == BodyShape::CIRCLE) {
+                info.points[0] = bodies.position(i) + normal * bodies.radius[i];
+                info.depths[0] = reach - wallOffset;
+                info.pointCount = 1;
+            } else {
+                // Keep the two vertices furthest into the wall.
+                bodies.refreshVertices(i);
+                const sf::Vector2f* v = bodies.vertices(i);
+                for (size_t k = 0; k < bodies.vertexCount(i); k++) {
+                    float depth = v[k].x * normal.x + v[k].y * normal.y - wallOffset;
+                    if (depth < -margin) continue;
+                    if (info.pointCount < 2) {
+                        info.points[info.pointCount] = v[k];
+                        info.depths[info.pointCount] = depth;
+                        info.features[info.pointCount] = static_cast<std::uint32_t>(k);
+                        info.pointCount++;
+                    } else {
+                        int shallow = info.depths[0] < info.depths[1] ? 0 : 1;
+                        if (depth > info.depths[shallow]) {
+                            info.points[shallow] = v[k];
+                            info.depths[shallow] = depth;
+                            info.features[shallow] = static_cast<std::uint32_t>(k);
+                        }
+                    }
+                }
+                if (info.pointCount == 0) continue;
+            }
+
+            info.point = info.points[0];
+            float deepest = info.pointCount > 1 ? std::max(info.depths[0], info.depths[1]) : info.depths[0];
+            info.penetrationDepth = std::max(0.0f, deepest);
+            contacts.push_back(contact);
+        }
+    }
+}
+
+void PhysicsWorld::advanceBullet(size_t i, float dt) {
+    const int maxImpacts = 4;
+
+    float remaining = dt;
+    for (int impact = 0; impact < maxImpacts && remaining > 0.0f; impact++) {
+        sf::Vector2f motion = bodies.velocity(i) * remaining;
+        AABB swept = bodies.aabbs[i];
+        swept.min += sf::Vector2f(std::min(motion.x, 0.0f), std::min(motion.y, 0.0f));
+        swept.max += sf::Vector2f(std::max(motion.x, 0.0f), std::max(motion.y, 0.0f));
+        queryMovable(swept, queryResults);
+        queryStatics(swept, queryResults, staticHits);
+
+        bodies.refreshVertices(i);
+        CollisionHandler::ShapeView shape = CollisionHandler::bodyShape(bodies, i);
+        float toi = 1.0f;
+        size_t hit = i;
+        CollisionHandler::CollisionInfo hitInfo;
+        for (size_t j : queryResults) {
+            // Other bullets haven't moved yet; bullet pairs are left to the solver.
+            if (j == i || bodies.bullet[j]) continue;
+
+            float t;
+            CollisionHandler::CollisionInfo info;
+            bodies.refreshVertices(j);
+            if (CollisionHandler::sweep(shape, motion, CollisionHandler::bodyShape(bodies, j), sweepScratch, t, info) && t < toi) {
+                toi = t;
+                hit = j;
+                hitInfo = info;
+            }
+        }
+
+        bodies.translate(i, motion * toi);
+        if (hit == i) break;
+
+        // Rewind to the impact, bounce there, and spend what's left of the
+        // step moving on from that point.
+        resolveImpact(i, hit, hitInfo);
+        remaining *= 1.0f - toi;
+    }
+
+    // The sweep is translation only; rotation is applied after it and any
+    // overlap that introduces is left to the next solve.
+    bodies.angle[i] += bodies.angularVel[i] * dt;
+    bodies.poseChanged(i);
+    clampToBounds(i);
+}
+
+void PhysicsWorld::resolveImpact(size_t bullet, size_t other, const CollisionHandler::CollisionInfo& info) {
+    const float restitution = 0.6f;
+    const float restitutionThreshold = 30.0f;
+
+    bodies.wake(other);
+    sf::Vector2f normal = info.normal;
+    sf::Vector2f rA = info.point - bodies.position(bullet);
+    sf::Vector2f rB = info.point - bodies.position(other);
+    float rnA = rA.x * normal.y - rA.y * normal.x;
+    float rnB = rB.x * normal.y - rB.y * normal.x;
+    float invMassSum = bodies.invMass[bullet] + bodies.invMass[other] +
+                       bodies.invInertia[bullet] * rnA * rnA + bodies.invInertia[other] * rnB * rnB;
+    if (invMassSum <= 0.0f) return;
+
+    // Velocities of the contact point on each body, including spin.
+    sf::Vector2f velocityA = bodies.velocity(bullet) + sf::Vector2f(-bodies.angularVel[bullet] * rA.y, bodies.angularVel[bullet] * rA.x);
+    sf::Vector2f velocityB = bodies.velocity(other) + sf::Vector2f(-bodies.angularVel[other] * rB.y, bodies.angularVel[other] * rB.x);
+    sf::Vector2f relativeVelocity = velocityB - velocityA;
+    float velAlongNormal = relativeVelocity.x * normal.x + relativeVelocity.y * normal.y;
+    if (velAlongNormal >= 0.0f) return;
+
+    float e = -velAlongNormal > restitutionThreshold ? restitution : 0.0f;
+    float magnitude = -(1.0f + e) * velAlongNormal / invMassSum;
+    sf::Vector2f impulse = normal * magnitude;
+    bodies.velX[bullet] -= impulse.x * bodies.invMass[bullet];
+    bodies.velY[bullet] -= impulse.y * bodies.invMass[bullet];
+    bodies.angularVel[bullet] -= bodies.invInertia[bullet] * rnA * magnitude;
+    bodies.velX[other] += impulse.x * bodies.invMass[other];
+    bodies.velY[other] += impulse.y * bodies.invMass[other];
+    bodies.angularVel[other] += bodies.invInertia[other] * rnB * magnitude;
+}
+
+void PhysicsWorld::wakeTouchedIslands() {
+    // Runs on the broad-phase candidates before sleeping pairs are dropped,
+    // so a disturbed island keeps the contacts between its own bodies. Only
+    // a body that wasn't resting last step disturbs: settling neighbours
+    // whose boxes merely overlap would keep a pile from ever sleeping.
+    groupsToWake.clear();
+    for (const BroadPhase::Pair& pair : candidatePairs) {
+        bool awakeA = bodies.awake[pair.first] != 0;
+        bool awakeB = bodies.awake[pair.second] != 0;
+        size_t sleeper = awakeA ? pair.second : pair.first;
+        size_t mover = awakeA ? pair.first : pair.second;
+        if (awakeA != awakeB && bodies.type[sleeper] == BodyType::DYNAMIC && inMotion(bodies, mover) &&
+            (bodies.type[mover] == BodyType::KINEMATIC || bodies.sleepTime[mover] == 0.0f)) {
+            groupsToWake.push_back(bodies.sleepGroup[sleeper]);
+        }
+    }
+    wakeGroups();
+}
+
+void PhysicsWorld::wakeContactIslands() {
+    // Catches bodies that crept into a sleeper too slowly to wake it above.
+    groupsToWake.clear();
+    for (const auto& contact : contacts) {
+        if (contact.bodyB == CollisionHandler::WORLD) continue;
+        bool awakeA = bodies.awake[contact.bodyA] != 0;
+        bool awakeB = bodies.awake[contact.bodyB] != 0;
+        size_t sleeper = awakeA ? contact.bodyB : contact.bodyA;
+        // Statics never wake, and a sleeper is only disturbed by a body in motion.
+        if (awakeA != awakeB && bodies.type[sleeper] == BodyType::DYNAMIC &&
+            inMotion(bodies, awakeA ? contact.bodyA : contact.bodyB)) {
+            groupsToWake.push_back(bodies.sleepGroup[sleeper]);
+        }
+    }
+    wakeGroups();
+}
+
+void PhysicsWorld::wakeGroups() {
+    if (groupsToWake.empty()) return;
+
+    std::sort(groupsToWake.begin(), groupsToWake.end());
+    for (size_t i : movableIndices) {
+        if (!bodies.awake[i] && std::binary_search(groupsToWake.begin(), groupsToWake.end(), bodies.sleepGroup[i])) {
+            bodies.wake(i);
+        }
+    }
+}
+
+void PhysicsWorld::updateSleep(float dt) {
+    collisionStats.awakeBodies = 0;
+    collisionStats.sleepingBodies = 0;
+    collisionStats.staticBodies = staticTree.size();
+
+    if (!sleepingEnabled) {
+        collisionStats.awakeBodies = bodies.size() - staticTree.size();
+        return;
+    }
+
+    const float threshold2 = sleepVelocity * sleepVelocity;
+    // Indexed by island root, which is always a dynamic body; only the roots
+    // of this step's islands are reset.
+    islandSleepTime.resize(bodies.size());
+    for (size_t i : movableIndices) {
+        if (bodies.awake[i] && bodies.type[i] == BodyType::DYNAMIC) {
+            islandSleepTime[solver.islandRoot(i)] = std::numeric_limits<float>::max();
+        }
+    }
+
+    // Only dynamic bodies sleep: statics always do and kinematic ones never.
+    for (size_t i : movableIndices) {
+        if (!bodies.awake[i] || bodies.type[i] != BodyType::DYNAMIC) continue;
+
+        // Use the distance actually travelled this step: a resting body's
+        // velocity can still hold a little of gravity's kick that position
+        // correction undoes.
+        float dx = bodies.posX[i] - bodies.prevX[i];
+        float dy = bodies.posY[i] - bodies.prevY[i];
+        float speed2 = (dx * dx + dy * dy) / (dt * dt);
+        // Spin counts through the speed it gives the body's outermost point.
+        const AABB& box = bodies.aabbs[i];
+        float halfDiagonal2 = 0.25f * ((box.max.x - box.min.x) * (box.max.x - box.min.x) +
+                                       (box.max.y - box.min.y) * (box.max.y - box.min.y));
+        float spin = (bodies.angle[i] - bodies.prevAngle[i]) / dt;
+        float spinSpeed2 = spin * spin * halfDiagonal2;
+        bool resting = speed2 < threshold2 && spinSpeed2 < threshold2;
+        bodies.sleepTime[i] = resting ? bodies.sleepTime[i] + dt : 0.0f;
+
+        std::uint32_t root = solver.islandRoot(i);
+        islandSleepTime[root] = std::min(islandSleepTime[root], bodies.sleepTime[i]);
+    }
+
+    for (size_t i : movableIndices) {
+        if (bodies.awake[i] && bodies.type[i] == BodyType::DYNAMIC) {
+            std::uint32_t root = solver.islandRoot(i);
+            if (islandSleepTime[root] >= timeToSleep) {
+                bodies.awake[i] = 0;
+                bodies.sleepGroup[i] = root;
+                bodies.velX[i] = bodies.velY[i] = 0.0f;
+                bodies.angularVel[i] = 0.0f;
+            }
+        }
+
+        if (bodies.awake[i]) collisionStats.awakeBodies++;
+        else collisionStats.sleepingBodies++;
+    }
+}
+
+void PhysicsWorld::setSleepingEnabled(bool enabled) {
+    if (recorder) recorder->recordSleeping(enabled);
+    sleepingEnabled = enabled;
+    if (!enabled) {
+        bodies.wakeAll();
+    }
+}
+
+void PhysicsWorld::setSleepThresholds(float velocity, float time) {
+    if (recorder) recorder->recordSleepThresholds(velocity, time);
+    sleepVelocity = velocity;
+    timeToSleep = time;
+}
+
+void PhysicsWorld::setSolverIterations(int iterations) {
+    if (recorder) recorder->recordSolverIterations(iterations);
+    solver.setIterations(iterations);
+}
+
+void PhysicsWorld::setWarmStarting(bool enabled) {
+    if (recorder) recorder->recordWarmStarting(enabled);
+    solver.setWarmStarting(enabled);
+}
+
+void PhysicsWorld::setContinuousCollision(bool enabled) {
+    if (recorder) recorder->recordContinuousCollision(enabled);
+    continuousCollision = enabled;
+}
+
+BodyHandle PhysicsWorld::createPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density) {
+    if (recorder) recorder->recordPolygon(vertices, velocity, color, density);
+    BodyHandle handle = bodies.createPolygon(vertices, velocity, color, density);
+    broadPhaseStale = true;
+    movableStale = true;
+    LOG(LogCategory::WORLD, LogLevel::DEBUG) << "Polygon body created with " << vertices.size() << " vertices";
+    return handle;
+}
+
+BodyHandle PhysicsWorld::createCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density) {
+    if (recorder) recorder->recordCircle(center, radius, velocity, color, density);
+    BodyHandle handle = bodies.createCircle(center, radius, velocity, color, density);
+    broadPhaseStale = true;
+    movableStale = true;
+    LOG(LogCategory::WORLD, LogLevel::DEBUG) << "Circle body created at (" << center.x << ", " << center.y << ") with radius " << radius;
+    return handle;
+}
+
+// Whatever was resting on a removed body has to be able to fall, and sleep
+// groups refer to dense indices that shift on removal, so wake everything.
+void PhysicsWorld::removeBody(BodyHandle handle) {
+    if (recorder) recorder->recordRemove(handle);
+    bodies.destroy(handle);
+    bodies.wakeAll();
+    broadPhaseStale = true;
+    movableStale = true;
+}
+
+void PhysicsWorld::removeLastRigidBody() {
+    if (bodies.size() > 0) {
+        removeBody(bodies.handleAt(bodies.size() - 1));
+    }
+}
+
+void PhysicsWorld::spawnLiquidObjects(const sf::Vector2f& position, int count) {
+    if (recorder) recorder->recordSpawn(position, count);
+    particles.spawn(position, static_cast<size_t>(count), rng);
+}
+
+void PhysicsWorld::clear() {
+    if (recorder) recorder->recordClear();
+    bodies.clear();
+    broadPhaseStale = true;
+    movableStale = true;
+    refreshBodyLists();
+    solver.clearPairs();
+    rng.seed(seed);
+    stepCount = 0;
+    stepHash = 0;
+    accumulator = 0.0f;
+
+    particles.clear();
+}
+
+void PhysicsWorld::setGravity(const sf::Vector2f& g) {
+    if (recorder) recorder->recordGravity(g);
+    gravity = g;
+    bodies.wakeAll();
+    particles.setGravity(gravity);
+}
+
+void PhysicsWorld::setBounds(const sf::FloatRect& rect) {
+    if (recorder) recorder->recordBounds(rect);
+    bounds = rect;
+    bodies.wakeAll();
+}
+
+void PhysicsWorld::setWallsEnabled(bool enabled) {
+    if (recorder) recorder->recordWalls(enabled);
+    wallsEnabled = enabled;
+    bodies.wakeAll();
+}
+
+void PhysicsWorld::queryBodies(const AABB& box, std::vector<size_t>& result) {
+    if (broadPhaseStale || bodies.getStaticRevision() != staticTreeRevision) {
+        buildBroadPhase();
+        broadPhaseStale = false;
+    }
+    queryMovable(box, result);
+    size_t movable = result.size();
+    queryStatics(box, result, staticHits);
+    if (result.size() > movable) {
+        std::sort(result.begin(), result.end());
+    }
+}
+
+void PhysicsWorld::refreshBodyLists() {
+    if (bodies.getStaticRevision() != staticTreeRevision) {
+        PROFILE_ZONE("Static tree");
+        staticTree.build(bodies);
+        staticTreeRevision = bodies.getStaticRevision();
+        movableStale = true;
+        // The step only carries the movable bodies' poses over to prev, so a
+        // static that moved or just became static gets its own here.
+        for (size_t i = 0; i < bodies.size(); i++) {
+            if (bodies.type[i] != BodyType::STATIC) continue;
+            bodies.prevX[i] = bodies.posX[i];
+            bodies.prevY[i] = bodies.posY[i];
+            bodies.prevAngle[i] = bodies.angle[i];
+        }
+    }
+    if (!movableStale) return;
+
+    movableIndices.clear();
+    movableRanges.clear();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (bodies.type[i] == BodyType::STATIC) continue;
+        movableIndices.push_back(i);
+        if (!movableRanges.empty() && movableRanges.back().second == i &&
+            i - movableRanges.back().first < INTEGRATE_GRAIN) {
+            movableRanges.back().second++;
+        } else {
+            movableRanges.emplace_back(i, i + 1);
+        }
+    }
+    movableStale = false;
+}
+
+void PhysicsWorld::forMovableRanges(const ThreadPool::RangeFn& fn) {
+    if (movableRanges.empty()) return;
+    // Enough ranges per task to make about INTEGRATE_GRAIN bodies; one when
+    // there are no statics to break the runs up.
+    size_t grain = INTEGRATE_GRAIN * movableRanges.size() / std::max<size_t>(1, movableIndices.size());
+    pool->parallelFor(movableRanges.size(), grain, [&](size_t first, size_t last, size_t slot) {
+        for (size_t r = first; r < last; r++) {
+            fn(movableRanges[r].first, movableRanges[r].second, slot);
+        }
+    });
+}
+
+void PhysicsWorld::buildBroadPhase() {
+    refreshBodyLists();
+    if (staticTree.size() == 0) {
+        broadPhase->build(bodies.aabbs);
+        return;
+    }
+
+    movableBoxes.resize(movableIndices.size());
+    for (size_t k = 0; k < movableIndices.size(); k++) {
+        movableBoxes[k] = bodies.aabbs[movableIndices[k]];
+    }
+    broadPhase->build(movableBoxes);
+}
+
+void PhysicsWorld::queryMovable(const AABB& box, std::vector<size_t>& result) const {
+    broadPhase->query(box, result);
+    if (staticTree.size() == 0) return;
+    for (size_t& index : result) {
+        index = movableIndices[index];
+    }
+}
+
+void PhysicsWorld::queryStatics(const AABB& box, std::vector<size_t>& result, std::vector<std::uint32_t>& hits) const {
+    staticTree.query(box, hits);
+    for (std::uint32_t id : hits) {
+        result.push_back(bodies.indexOfId(id));
+    }
+}
+
+void PhysicsWorld::findStaticPairs() {
+    if (staticTree.size() == 0) return;
+
+    // Only awake dynamic bodies look for statics: a sleeping one keeps its
+    // contacts, and nothing else responds to them.
+    staticScratch.resize(pool->size());
+    for (StaticScratch& scratch : staticScratch) {
+        scratch.pairs.clear();
+    }
+    pool->parallelFor(movableIndices.size(), 256, [&](size_t begin, size_t end, size_t slot) {
+        StaticScratch& scratch = staticScratch[slot];
+        for (size_t k = begin; k < end; k++) {
+            size_t i = movableIndices[k];
+            if (!bodies.awake[i] || bodies.type[i] != BodyType::DYNAMIC) continue;
+            staticTree.query(bodies.aabbs[i], scratch.hits);
+            for (std::uint32_t id : scratch.hits) {
+                size_t j = bodies.indexOfId(id);
+                scratch.pairs.emplace_back(std::min(i, j), std::max(i, j));
+            }
+        }
+    });
+
+    // Unordered, unlike the broad phase's pairs; the narrow phase sorts its
+    // contacts, so nothing downstream depends on the order.
+    for (const StaticScratch& scratch : staticScratch) {
+        candidatePairs.insert(candidatePairs.end(), scratch.pairs.begin(), scratch.pairs.end());
+    }
+}
+
+void PhysicsWorld::setBodyType(BodyHandle handle, BodyType type) {
+    if (!bodies.contains(handle)) return;
+    if (recorder) recorder->recordBodyType(handle, type);
+    bodies.setType(bodies.indexOf(handle), type);
+    broadPhaseStale = true;
+    movableStale = true;
+}
+
+void PhysicsWorld::setThreadCount(size_t threads) {
+    pool.reset(new ThreadPool(threads));
+    particles.setThreadPool(pool.get());
+}
+
+void PhysicsWorld::setBroadPhase(BroadPhaseType type) {
+    if (recorder) recorder->recordBroadPhase(type);
+    if (type == BroadPhaseType::SPATIAL_HASH) {
+        broadPhase.reset(new SpatialHash());
+    } else {
+        broadPhase.reset(new SweepAndPrune());
+    }
+    broadPhaseStale = true;
+}
+
+void PhysicsWorld::setIntegrationScheme(IntegrationScheme scheme) {
+    if (recorder) recorder->recordIntegrationScheme(scheme);
+    integrationScheme = scheme;
+}
+
+void PhysicsWorld::setLiquidDensity(float density) {
+    if (recorder) recorder->recordLiquidDensity(density);
+    particles.setDensity(density);
+}
+
+void PhysicsWorld::setLiquidModel(LiquidModel model) {
+    if (recorder) recorder->recordLiquidModel(model);
+    particles.setModel(model);
+}
+
+void PhysicsWorld::setLiquidCapacity(size_t capacity) {
+    if (recorder) recorder->recordLiquidCapacity(capacity);
+    particles.setCapacity(capacity);
+}
@@ -0,0 +1,203 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint32_t> nextThreadId{0};
+
+}
+
+#ifdef PHYSICS_PROFILING
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now()), frames(HISTORY) {
+    for (Frame& frame : frames) {
+        frame.zones.reserve(256);
+        frame.counters.reserve(16);
+    }
+    frames[current].startUs = 0;
+}
+
+int64_t Profiler::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+uint32_t Profiler::threadId() {
+    thread_local uint32_t id = nextThreadId.fetch_add(1);
+    return id;
+}
+
+uint64_t Profiler::allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+Profiler::ThreadZones& Profiler::threadZones() {
+    thread_local std::shared_ptr<ThreadZones> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadZones>();
+        buffer->zones.reserve(256);
+        std::lock_guard<std::mutex> lock(mutex);
+        threadBuffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Profiler::addZone(const char* name, int64_t startUs, int64_t endUs) {
+    uint32_t thread = threadId();
+    ThreadZones& buffer = threadZones();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.zones.size() < MAX_ZONES_PER_FRAME) {
+        buffer.zones.push_back({name, thread, startUs, endUs});
+    }
+}
+
+void Profiler::addCounter(const char* name, double value) {
+    if (!isEnabled()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Counter& counter : frames[current].counters) {
+        if (std::strcmp(counter.name, name) == 0) {
+            counter.value += value;
+            return;
+        }
+    }
+    frames[current].counters.push_back({name, value});
+}
+
+void Profiler::endFrame() {
+    int64_t now = nowUs();
+    uint64_t allocs = allocationCount();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Frame& frame = frames[current];
+    for (const std::shared_ptr<ThreadZones>& buffer : threadBuffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        size_t room = MAX_ZONES_PER_FRAME - std::min(MAX_ZONES_PER_FRAME, frame.zones.size());
+        frame.zones.insert(frame.zones.end(), buffer->zones.begin(),
+                           buffer->zones.begin() + std::min(room, buffer->zones.size()));
+        buffer->zones.clear();
+    }
+    // Only the registry still holds buffers of threads that have exited.
+    threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(),
+                                       [](const std::shared_ptr<ThreadZones>& buffer) { return buffer.use_count() == 1; }),
+                        threadBuffers.end());
+    frame.endUs = now;
+    frame.counters.push_back({"allocations", static_cast<double>(allocs - frameAllocStart)});
+
+    current = (current + 1) % HISTORY;
+    completed++;
+    frames[current].zones.clear();
+    frames[current].counters.clear();
+    frames[current].startUs = now;
+    // Don't charge this frame for the bookkeeping above.
+    frameAllocStart = allocationCount();
+}
+
+template <typename Fn>
+std::vector<float> Profiler::history(Fn valueOf) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = std::min(completed, HISTORY - 1);
+    std::vector<float> values;
+    values.reserve(count);
+    for (size_t k = 0; k < count; k++) {
+        values.push_back(valueOf(frames[(current + HISTORY - count + k) % HISTORY]));
+    }
+    return values;
+}
+
+std::vector<float> Profiler::frameHistory() const {
+    return history([](const Frame& frame) {
+        return (frame.endUs - frame.startUs) / 1000.0f;
+    });
+}
+
+std::vector<float> Profiler::zoneHistory(const char* name) const {
+    return history([name](const Frame& frame) {
+        int64_t total = 0;
+        for (const Zone& zone : frame.zones) {
+            if (std::strcmp(zone.name, name) == 0) {
+                total += zone.endUs - zone.startUs;
+            }
+        }
+        return total / 1000.0f;
+    });
+}
+
+std::vector<float> Profiler::counterHistory(const char* name) const {
+    return history([name](const Frame& frame) {
+        for (const Counter& counter : frame.counters) {
+            if (std::strcmp(counter.name, name) == 0) {
+                return static_cast<float>(counter.value);
+            }
+        }
+        return 0.0f;
+    });
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = std::min(completed, HISTORY - 1);
+    bool first = true;
+    out << "{\"traceEvents\":[\n";
+    for (size_t k = 0; k < count; k++) {
+        const Frame& frame = frames[(current + HISTORY - count + k) % HISTORY];
+        for (const Zone& zone : frame.zones) {
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"" << zone.name << "\",\"cat\":\"physics\",\"ph\":\"X\",\"pid\":1"
+                << ",\"tid\":" << zone.thread << ",\"ts\":" << zone.startUs
+                << ",\"dur\":" << (zone.endUs - zone.startUs) << "}";
+            first = false;
+        }
+        for (const Counter& counter : frame.counters) {
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"" << counter.name << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << frame.startUs
+                << ",\"args\":{\"value\":" << counter.value << "}}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
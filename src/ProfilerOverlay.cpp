@@ -0,0 +1,98 @@
+#include "ProfilerOverlay.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font)
+    : font(font), bars(sf::Quads) {
+    addSeries("Frame", nullptr, nullptr, sf::Color(220, 220, 220));
+    addSeries("Update", "Update", nullptr, sf::Color(200, 200, 120));
+    addSeries("Draw", "Draw", nullptr, sf::Color(200, 150, 220));
+    addSeries("Forces", "Forces", nullptr, sf::Color(120, 200, 120));
+    addSeries("Broad phase", "Broad phase", nullptr, sf::Color(120, 180, 240));
+    addSeries("Narrow phase", "Narrow phase", nullptr, sf::Color(240, 160, 80));
+    addSeries("Solve", "Solve", nullptr, sf::Color(240, 100, 100));
+    addSeries("Integrate", "Integrate", nullptr, sf::Color(100, 220, 200));
+    addSeries("Particles", "Particles", nullptr, sf::Color(80, 180, 200));
+    addSeries("Pairs", nullptr, "pairs", sf::Color(180, 180, 255));
+    addSeries("Contacts", nullptr, "contacts", sf::Color(255, 180, 180));
+    addSeries("Draw calls", nullptr, "draw calls", sf::Color(200, 200, 255));
+    addSeries("Allocations", nullptr, "allocations", sf::Color(255, 220, 120));
+
+    background.setFillColor(sf::Color(20, 20, 20, 210));
+    background.setSize(sf::Vector2f(WIDTH, series.size() * ROW_HEIGHT + 10.0f));
+}
+
+void ProfilerOverlay::addSeries(const std::string& label, const char* zone, const char* counter, sf::Color color) {
+    Series s{label, zone, counter, color, sf::Text()};
+    s.text.setFont(font);
+    s.text.setCharacterSize(11);
+    s.text.setFillColor(sf::Color::White);
+    series.push_back(s);
+}
+
+void ProfilerOverlay::setPosition(const sf::Vector2f& value) {
+    position = value;
+    background.setPosition(position);
+}
+
+void ProfilerOverlay::update() {
+    if (!visible) return;
+
+    Profiler& profiler = Profiler::get();
+    const float barArea = WIDTH - 20.0f;
+    const float barWidth = barArea / (Profiler::HISTORY - 1);
+
+    bars.clear();
+    for (size_t row = 0; row < series.size(); row++) {
+        Series& s = series[row];
+        std::vector<float> values;
+        if (s.zone) {
+            values = profiler.zoneHistory(s.zone);
+        } else if (s.counter) {
+            values = profiler.counterHistory(s.counter);
+        } else {
+            values = profiler.frameHistory();
+        }
+
+        float latest = values.empty() ? 0.0f : values.back();
+        float peak = 0.0f;
+        float sum = 0.0f;
+        for (float v : values) {
+            peak = std::max(peak, v);
+            sum += v;
+        }
+        float average = values.empty() ? 0.0f : sum / values.size();
+
+        std::stringstream stream;
+        stream << std::fixed << std::setprecision(s.counter ? 0 : 2)
+               << s.label << ": " << latest << "  avg " << average << "  max " << peak
+               << (s.counter ? "" : " ms");
+        float top = position.y + 5.0f + row * ROW_HEIGHT;
+        s.text.setString(stream.str());
+        s.text.setPosition(position.x + 10.0f, top);
+
+        // Scale each row to its own peak; the label carries the absolute numbers.
+        float baseline = top + 14.0f + BAR_HEIGHT;
+        float x = position.x + 10.0f + (Profiler::HISTORY - 1 - values.size()) * barWidth;
+        for (float v : values) {
+            float h = peak > 0.0f ? v / peak * BAR_HEIGHT : 0.0f;
+            bars.append(sf::Vertex(sf::Vector2f(x, baseline - h), s.color));
+            bars.append(sf::Vertex(sf::Vector2f(x + barWidth, baseline - h), s.color));
+            bars.append(sf::Vertex(sf::Vector2f(x + barWidth, baseline), s.color));
+            bars.append(sf::Vertex(sf::Vector2f(x, baseline), s.color));
+            x += barWidth;
+        }
+    }
+}
+
+void ProfilerOverlay::draw(sf::RenderWindow& window) {
+    if (!visible) return;
+
+    window.draw(background);
+    window.draw(bars);
+    for (const Series& s : series) {
+        window.draw(s.text);
+    }
+}
@@ -0,0 +1,291 @@
+#include "Recorder.hpp"
+#include <cstring>
+#include "Logger.hpp"
+#include "PhysicsWorld.hpp"
+#include "Profiler.hpp"
+#include "Snapshot.hpp"
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(const std::string& path, PhysicsWorld& target) {
+    stop();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not open recording " << path;
+        return false;
+    }
+    FileHeader header{{'P', 'R', 'E', 'C'}, 0x01020304u, VERSION, 0};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    world = &target;
+    world->setRecorder(this);
+    stopping = false;
+    warnedCustomForce = false;
+    writer = std::thread(&Recorder::writeLoop, this);
+    recordKeyframe(true);
+    flush();
+    LOG(LogCategory::WORLD, LogLevel::INFO) << "Recording to " << path;
+    return true;
+}
+
+void Recorder::stop() {
+    if (!world) {
+        return;
+    }
+    record(RecordType::END, nullptr, 0);
+    flush();
+    world->setRecorder(nullptr);
+    world = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    file.close();
+}
+
+void Recorder::recordPolygon(const std::vector<sf::Vector2f>& vertices, sf::Vector2f velocity, sf::Color color, float density) {
+    PolygonRecord payload{velocity, color, density, static_cast<std::uint32_t>(vertices.size()), 0};
+    record(RecordType::CREATE_POLYGON, &payload, sizeof(payload), vertices.data(), vertices.size() * sizeof(sf::Vector2f));
+}
+
+void Recorder::recordCircle(const sf::Vector2f& center, float radius, sf::Vector2f velocity, sf::Color color, float density) {
+    CircleRecord payload{center, velocity, color, radius, density, 0};
+    record(RecordType::CREATE_CIRCLE, &payload, sizeof(payload));
+}
+
+void Recorder::recordRemove(BodyHandle handle) {
+    record(RecordType::REMOVE_BODY, &handle, sizeof(handle));
+}
+
+void Recorder::recordBodyType(BodyHandle handle, BodyType type) {
+    BodyTypeRecord payload{handle, static_cast<std::uint32_t>(type), 0};
+    record(RecordType::SET_BODY_TYPE, &payload, sizeof(payload));
+}
+
+void Recorder::recordBodyPosition(BodyHandle handle, const sf::Vector2f& position) {
+    BodyVectorRecord payload{handle, position};
+    record(RecordType::SET_BODY_POSITION, &payload, sizeof(payload));
+}
+
+void Recorder::recordBodyAngle(BodyHandle handle, float angle) {
+    BodyValueRecord payload{handle, angle, 0};
+    record(RecordType::SET_BODY_ANGLE, &payload, sizeof(payload));
+}
+
+void Recorder::recordBodyVelocity(BodyHandle handle, const sf::Vector2f& velocity) {
+    BodyVectorRecord payload{handle, velocity};
+    record(RecordType::SET_BODY_VELOCITY, &payload, sizeof(payload));
+}
+
+void Recorder::recordBodyAngularVelocity(BodyHandle handle, float angularVelocity) {
+    BodyValueRecord payload{handle, angularVelocity, 0};
+    record(RecordType::SET_BODY_ANGULAR_VELOCITY, &payload, sizeof(payload));
+}
+
+void Recorder::recordTorque(BodyHandle handle, float torque) {
+    BodyValueRecord payload{handle, torque, 0};
+    record(RecordType::APPLY_TORQUE, &payload, sizeof(payload));
+}
+
+void Recorder::recordBullet(BodyHandle handle, bool bullet) {
+    BodyFlagRecord payload{handle, bullet ? 1u : 0u, 0};
+    record(RecordType::SET_BULLET, &payload, sizeof(payload));
+}
+
+void Recorder::recordWake(BodyHandle handle) {
+    record(RecordType::WAKE_BODY, &handle, sizeof(handle));
+}
+
+void Recorder::recordForce(BodyHandle handle, const ForceDef& force) {
+    ForceRecord payload{handle, static_cast<std::uint32_t>(force.type), force.vector, force.coefficient, force.damping, 0};
+    record(RecordType::ADD_FORCE, &payload, sizeof(payload));
+}
+
+void Recorder::recordCustomForce(BodyHandle handle) {
+    if (warnedCustomForce) {
+        return;
+    }
+    warnedCustomForce = true;
+    LOG(LogCategory::WORLD, LogLevel::WARNING) << "Custom force on body " << handle.id
+                                               << " is not recorded; replay will diverge from here";
+}
+
+void Recorder::recordRemoveForces(BodyHandle handle, ForceType type) {
+    BodyFlagRecord payload{handle, static_cast<std::uint32_t>(type), 0};
+    record(RecordType::REMOVE_FORCES, &payload, sizeof(payload));
+}
+
+void Recorder::recordSpawn(const sf::Vector2f& position, int count) {
+    SpawnRecord payload{position, count, 0};
+    record(RecordType::SPAWN_LIQUID, &payload, sizeof(payload));
+}
+
+void Recorder::recordGravity(const sf::Vector2f& gravity) {
+    record(RecordType::SET_GRAVITY, &gravity, sizeof(gravity));
+}
+
+void Recorder::recordLiquidDensity(float density) {
+    record(RecordType::SET_LIQUID_DENSITY, &density, sizeof(density));
+}
+
+void Recorder::recordLiquidModel(LiquidModel model) {
+    std::uint32_t value = static_cast<std::uint32_t>(model);
+    record(RecordType::SET_LIQUID_MODEL, &value, sizeof(value));
+}
+
+void Recorder::recordLiquidCapacity(size_t capacity) {
+    std::uint64_t value = capacity;
+    record(RecordType::SET_LIQUID_CAPACITY, &value, sizeof(value));
+}
+
+void Recorder::recordBroadPhase(BroadPhaseType type) {
+    std::uint32_t value = static_cast<std::uint32_t>(type);
+    record(RecordType::SET_BROAD_PHASE, &value, sizeof(value));
+}
+
+void Recorder::recordBounds(const sf::FloatRect& bounds) {
+    record(RecordType::SET_WORLD_BOUNDS, &bounds, sizeof(bounds));
+}
+
+void Recorder::recordWalls(bool enabled) {
+    std::uint32_t value = enabled ? 1 : 0;
+    record(RecordType::SET_WALLS, &value, sizeof(value));
+}
+
+void Recorder::recordIntegrationScheme(IntegrationScheme scheme) {
+    std::uint32_t value = static_cast<std::uint32_t>(scheme);
+    record(RecordType::SET_INTEGRATION_SCHEME, &value, sizeof(value));
+}
+
+void Recorder::recordSleeping(bool enabled) {
+    std::uint32_t value = enabled ? 1 : 0;
+    record(RecordType::SET_SLEEPING, &value, sizeof(value));
+}
+
+void Recorder::recordSleepThresholds(float velocity, float time) {
+    SleepThresholdRecord payload{velocity, time};
+    record(RecordType::SET_SLEEP_THRESHOLDS, &payload, sizeof(payload));
+}
+
+void Recorder::recordSolverIterations(int iterations) {
+    std::int32_t value = iterations;
+    record(RecordType::SET_SOLVER_ITERATIONS, &value, sizeof(value));
+}
+
+void Recorder::recordWarmStarting(bool enabled) {
+    std::uint32_t value = enabled ? 1 : 0;
+    record(RecordType::SET_WARM_STARTING, &value, sizeof(value));
+}
+
+void Recorder::recordContinuousCollision(bool enabled) {
+    std::uint32_t value = enabled ? 1 : 0;
+    record(RecordType::SET_CONTINUOUS_COLLISION, &value, sizeof(value));
+}
+
+void Recorder::recordStepRate(float stepsPerSecond) {
+    record(RecordType::SET_STEP_RATE, &stepsPerSecond, sizeof(stepsPerSecond));
+}
+
+void Recorder::recordDeterministic(bool enabled) {
+    std::uint32_t value = enabled ? 1 : 0;
+    record(RecordType::SET_DETERMINISTIC, &value, sizeof(value));
+}
+
+void Recorder::recordSeed(std::uint32_t seed) {
+    record(RecordType::SET_SEED, &seed, sizeof(seed));
+}
+
+void Recorder::recordClear() {
+    record(RecordType::CLEAR, nullptr, 0);
+}
+
+void Recorder::recordSetting(const std::string& key, float value) {
+    SettingRecord payload{value, static_cast<std::uint32_t>(key.size())};
+    record(RecordType::SETTING, &payload, sizeof(payload), key.data(), key.size());
+}
+
+void Recorder::recordKeyframe(bool loaded) {
+    if (!world) {
+        return;
+    }
+    PROFILE_ZONE("Recorder keyframe");
+    KeyframeHeader header{world->computeStateHash(), loaded ? 1u : 0u, 0};
+    std::vector<char> snapshot = Snapshot::capture(*world);
+    record(RecordType::KEYFRAME, &header, sizeof(header), snapshot.data(), snapshot.size());
+    stepsSinceKeyframe = 0;
+}
+
+void Recorder::stepEnded() {
+    if (++stepsSinceKeyframe >= keyframeInterval) {
+        recordKeyframe();
+    }
+    flush();
+}
+
+void Recorder::record(RecordType type, const void* payload, size_t size) {
+    record(type, payload, size, nullptr, 0);
+}
+
+void Recorder::record(RecordType type, const void* first, size_t firstSize, const void* second, size_t secondSize) {
+    if (!world) {
+        return;
+    }
+    RecordHeader header{type, static_cast<std::uint32_t>(firstSize + secondSize), world->getStepCount()};
+    const char* h = reinterpret_cast<const char*>(&header);
+    pending.insert(pending.end(), h, h + sizeof(header));
+    if (firstSize > 0) {
+        const char* p = static_cast<const char*>(first);
+        pending.insert(pending.end(), p, p + firstSize);
+    }
+    if (secondSize > 0) {
+        const char* p = static_cast<const char*>(second);
+        pending.insert(pending.end(), p, p + secondSize);
+    }
+    pending.resize((pending.size() + 7) & ~size_t(7), 0);
+}
+
+void Recorder::flush() {
+    if (pending.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(pending));
+    }
+    pending.clear();
+    wake.notify_one();
+}
+
+void Recorder::writeLoop() {
+    std::vector<std::vector<char>> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty() && stopping) {
+                return;
+            }
+            batch.swap(queue);
+        }
+        for (const std::vector<char>& chunk : batch) {
+            file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }
+        file.flush();
+        batch.clear();
+    }
+}
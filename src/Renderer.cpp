@@ -0,0 +1,183 @@
+#include "Renderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float PI = 3.14159265f;
+const unsigned PARTICLE_SPRITE_SIZE = 32;
+
+// Roughly constant edge length in pixels, within sane bounds.
+size_t segmentsFor(float radius) {
+    return static_cast<size_t>(std::min(64.0f, std::max(6.0f, 6.0f + radius * 0.5f)));
+}
+
+}
+
+const std::vector<sf::Vector2f>& Renderer::circleOutline(float radius) {
+    size_t segments = segmentsFor(radius);
+    if (circleCache.size() <= segments) {
+        circleCache.resize(segments + 1);
+    }
+
+    std::vector<sf::Vector2f>& outline = circleCache[segments];
+    if (outline.empty()) {
+        outline.reserve(segments);
+        for (size_t k = 0; k < segments; k++) {
+            float angle = 2.0f * PI * k / segments;
+            outline.push_back(sf::Vector2f(std::cos(angle), std::sin(angle)));
+        }
+    }
+    return outline;
+}
+
+void Renderer::appendCircle(size_t& cursor, const sf::Vector2f& center, float radius, sf::Color color) {
+    const std::vector<sf::Vector2f>& outline = circleOutline(radius);
+    size_t segments = outline.size();
+    for (size_t k = 0; k < segments; k++) {
+        const sf::Vector2f& a = outline[k];
+        const sf::Vector2f& b = outline[(k + 1) % segments];
+        bodyBatch[cursor++] = sf::Vertex(center, color);
+        bodyBatch[cursor++] = sf::Vertex(center + a * radius, color);
+        bodyBatch[cursor++] = sf::Vertex(center + b * radius, color);
+    }
+}
+
+size_t Renderer::bodyVertexCount(const BodyStore& bodies, size_t i) const {
+    if (bodies.shape[i] == BodyShape::POLYGON) {
+        return (bodies.vertexCount(i) - 2) * 3;
+    }
+    return segmentsFor(bodies.radius[i]) * 3;
+}
+
+void Renderer::appendBody(size_t& cursor, const BodyStore& bodies, size_t i, float alpha) {
+    // Draw at the pose interpolated between the last two steps.
+    sf::Vector2f previous = bodies.previousPosition(i);
+    sf::Vector2f center = previous + (bodies.position(i) - previous) * alpha;
+    float angle = bodies.prevAngle[i] + (bodies.angle[i] - bodies.prevAngle[i]) * alpha;
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    const sf::Vector2f* local = bodies.localVertices(i);
+    sf::Color color = bodies.colors[i];
+
+    if (bodies.shape[i] == BodyShape::POLYGON) {
+        auto place = [&](const sf::Vector2f& v) {
+            return sf::Vector2f(center.x + c * v.x - s * v.y, center.y + s * v.x + c * v.y);
+        };
+        // Bodies are convex, so a fan from the first vertex covers them.
+        sf::Vector2f origin = place(local[0]);
+        for (size_t k = 1; k + 1 < bodies.vertexCount(i); k++) {
+            bodyBatch[cursor++] = sf::Vertex(origin, color);
+            bodyBatch[cursor++] = sf::Vertex(place(local[k]), color);
+            bodyBatch[cursor++] = sf::Vertex(place(local[k + 1]), color);
+        }
+    } else {
+        appendCircle(cursor, center, bodies.radius[i], color);
+    }
+}
+
+const sf::Texture& Renderer::particleSprite() {
+    if (!particleTextureReady) {
+        // White disc with a one-pixel soft edge; vertex colours tint it.
+        sf::Image image;
+        image.create(PARTICLE_SPRITE_SIZE, PARTICLE_SPRITE_SIZE, sf::Color::Transparent);
+        float half = PARTICLE_SPRITE_SIZE * 0.5f;
+        for (unsigned y = 0; y < PARTICLE_SPRITE_SIZE; y++) {
+            for (unsigned x = 0; x < PARTICLE_SPRITE_SIZE; x++) {
+                float distance = std::hypot(x + 0.5f - half, y + 0.5f - half);
+                float coverage = std::min(1.0f, std::max(0.0f, half - distance));
+                image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(255.0f * coverage)));
+            }
+        }
+        particleTexture.loadFromImage(image);
+        particleTexture.setSmooth(true);
+        particleTextureReady = true;
+    }
+    return particleTexture;
+}
+
+void Renderer::appendParticle(size_t& cursor, const ParticleSystem& particles, size_t i, float alpha) {
+    sf::Color color = particles.getColor();
+    float opacity = 255.0f * (1.0f - (particles.age[i] / particles.lifetime[i]));
+    color.a = static_cast<sf::Uint8>(std::max(0.0f, opacity));
+
+    float x = particles.prevX[i] + (particles.posX[i] - particles.prevX[i]) * alpha;
+    float y = particles.prevY[i] + (particles.posY[i] - particles.prevY[i]) * alpha;
+    float r = particles.radius[i];
+    float size = static_cast<float>(PARTICLE_SPRITE_SIZE);
+    particleBatch[cursor++] = sf::Vertex(sf::Vector2f(x - r, y - r), color, sf::Vector2f(0.0f, 0.0f));
+    particleBatch[cursor++] = sf::Vertex(sf::Vector2f(x + r, y - r), color, sf::Vector2f(size, 0.0f));
+    particleBatch[cursor++] = sf::Vertex(sf::Vector2f(x + r, y + r), color, sf::Vector2f(size, size));
+    particleBatch[cursor++] = sf::Vertex(sf::Vector2f(x - r, y + r), color, sf::Vector2f(0.0f, size));
+}
+
+void Renderer::drawBodies(sf::RenderWindow& window, const BodyStore& bodies, float alpha) {
+    size_t vertexCount = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        vertexCount += bodyVertexCount(bodies, i);
+    }
+    if (vertexCount == 0) return;
+    bodyBatch.resize(vertexCount);
+
+    size_t cursor = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        appendBody(cursor, bodies, i, alpha);
+    }
+
+    window.draw(bodyBatch);
+    drawCalls++;
+}
+
+void Renderer::drawBodies(sf::RenderWindow& window, const BodyStore& bodies, const std::vector<size_t>& visible,
+                          float alpha) {
+    size_t vertexCount = 0;
+    for (size_t i : visible) {
+        vertexCount += bodyVertexCount(bodies, i);
+    }
+    if (vertexCount == 0) return;
+    bodyBatch.resize(vertexCount);
+
+    size_t cursor = 0;
+    for (size_t i : visible) {
+        appendBody(cursor, bodies, i, alpha);
+    }
+
+    window.draw(bodyBatch);
+    drawCalls++;
+}
+
+void Renderer::drawParticles(sf::RenderWindow& window, const ParticleSystem& particles, float alpha) {
+    size_t count = particles.size();
+    if (count == 0) return;
+    particleBatch.resize(count * 4);
+
+    size_t cursor = 0;
+    for (size_t i = 0; i < count; i++) {
+        appendParticle(cursor, particles, i, alpha);
+    }
+
+    window.draw(particleBatch, sf::RenderStates(&particleSprite()));
+    drawCalls++;
+}
+
+void Renderer::drawParticles(sf::RenderWindow& window, const ParticleSystem& particles, const AABB& view,
+                             float alpha) {
+    // Particles aren't in the broad phase, and one box test each is cheaper
+    // than triangulating them.
+    visibleParticles.clear();
+    for (size_t i = 0; i < particles.size(); i++) {
+        if (particles.getAABB(i).overlaps(view)) {
+            visibleParticles.push_back(i);
+        }
+    }
+    if (visibleParticles.empty()) return;
+    particleBatch.resize(visibleParticles.size() * 4);
+
+    size_t cursor = 0;
+    for (size_t i : visibleParticles) {
+        appendParticle(cursor, particles, i, alpha);
+    }
+
+    window.draw(particleBatch, sf::RenderStates(&particleSprite()));
+    drawCalls++;
+}
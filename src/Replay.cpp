@@ -0,0 +1,337 @@
+#include "Replay.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "Logger.hpp"
+#include "PhysicsWorld.hpp"
+#include "Snapshot.hpp"
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+template <typename T>
+bool readPayload(const char* payload, size_t size, T& out) {
+    if (size < sizeof(T)) return false;
+    std::memcpy(&out, payload, sizeof(T));
+    return true;
+}
+
+}
+
+bool Replay::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not open recording " << path;
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    records.clear();
+    keyframes.clear();
+    settings.clear();
+    cursor = 0;
+    verifiedKeyframes = 0;
+    divergences = 0;
+
+    FileHeader header;
+    if (!readPayload(bytes.data(), bytes.size(), header) || std::memcmp(header.magic, "PREC", 4) != 0 ||
+        header.byteOrder != 0x01020304u || header.version > Recorder::VERSION) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << path << " is not a recording this build can read";
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    while (bytes.size() - offset >= sizeof(Recorder::RecordHeader)) {
+        Recorder::RecordHeader record;
+        std::memcpy(&record, bytes.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.size > bytes.size() - offset) {
+            LOG(LogCategory::WORLD, LogLevel::WARNING) << "Recording " << path << " is truncated after step " << record.step;
+            break;
+        }
+        if (record.type == Recorder::RecordType::KEYFRAME) {
+            keyframes.push_back(records.size());
+        }
+        records.push_back({record.type, record.step, bytes.data() + offset, record.size});
+        offset += std::min(bytes.size() - offset, (static_cast<size_t>(record.size) + 7) & ~size_t(7));
+    }
+    if (keyframes.empty() || keyframes[0] != 0) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Recording " << path << " does not start with a keyframe";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::seek(PhysicsWorld& world, size_t keyframe) {
+    if (keyframe >= keyframes.size()) {
+        return false;
+    }
+    cursor = keyframes[keyframe];
+    if (!restoreKeyframe(world, records[cursor])) {
+        return false;
+    }
+    cursor++;
+    return true;
+}
+
+std::uint64_t Replay::run(PhysicsWorld& world, std::uint64_t maxSteps) {
+    std::uint64_t steps = 0;
+    while (cursor < records.size()) {
+        const Entry& entry = records[cursor];
+        if (entry.step > world.getStepCount()) {
+            if (steps == maxSteps) break;
+            world.step(world.getFixedTimestep());
+            steps++;
+            continue;
+        }
+        if (!apply(world, entry)) {
+            LOG(LogCategory::WORLD, LogLevel::WARNING) << "Skipped a malformed record at step " << entry.step;
+        }
+        cursor++;
+    }
+    return steps;
+}
+
+bool Replay::apply(PhysicsWorld& world, const Entry& entry) {
+    const char* payload = entry.payload;
+    size_t size = entry.size;
+    switch (entry.type) {
+        case Recorder::RecordType::KEYFRAME: {
+            Recorder::KeyframeHeader header;
+            if (!readPayload(payload, size, header)) return false;
+            if (header.loaded) {
+                return restoreKeyframe(world, entry);
+            }
+            if (world.computeStateHash() == header.stateHash) {
+                verifiedKeyframes++;
+                return true;
+            }
+            divergences++;
+            LOG(LogCategory::WORLD, LogLevel::WARNING) << "Replay diverged from the recording by step " << entry.step
+                                                       << "; resynchronising";
+            return restoreKeyframe(world, entry);
+        }
+        case Recorder::RecordType::CREATE_POLYGON: {
+            Recorder::PolygonRecord record;
+            if (!readPayload(payload, size, record) ||
+                size != sizeof(record) + record.vertexCount * sizeof(sf::Vector2f)) return false;
+            std::vector<sf::Vector2f> vertices(record.vertexCount);
+            std::memcpy(vertices.data(), payload + sizeof(record), record.vertexCount * sizeof(sf::Vector2f));
+            world.createPolygon(vertices, record.velocity, record.color, record.density);
+            return true;
+        }
+        case Recorder::RecordType::CREATE_CIRCLE: {
+            Recorder::CircleRecord record;
+            if (!readPayload(payload, size, record)) return false;
+            world.createCircle(record.center, record.radius, record.velocity, record.color, record.density);
+            return true;
+        }
+        case Recorder::RecordType::REMOVE_BODY: {
+            BodyHandle handle;
+            if (!readPayload(payload, size, handle)) return false;
+            world.removeBody(handle);
+            return true;
+        }
+        case Recorder::RecordType::SET_BODY_TYPE: {
+            Recorder::BodyTypeRecord record;
+            if (!readPayload(payload, size, record) ||
+                record.type > static_cast<std::uint32_t>(BodyType::KINEMATIC)) return false;
+            world.setBodyType(record.handle, static_cast<BodyType>(record.type));
+            return true;
+        }
+        case Recorder::RecordType::SET_BODY_POSITION: {
+            Recorder::BodyVectorRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).setCOM(record.value);
+            return true;
+        }
+        case Recorder::RecordType::SET_BODY_ANGLE: {
+            Recorder::BodyValueRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).setAngle(record.value);
+            return true;
+        }
+        case Recorder::RecordType::SET_BODY_VELOCITY: {
+            Recorder::BodyVectorRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).setVelocity(record.value);
+            return true;
+        }
+        case Recorder::RecordType::SET_BODY_ANGULAR_VELOCITY: {
+            Recorder::BodyValueRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).setAngularVelocity(record.value);
+            return true;
+        }
+        case Recorder::RecordType::APPLY_TORQUE: {
+            Recorder::BodyValueRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).applyTorque(record.value);
+            return true;
+        }
+        case Recorder::RecordType::SET_BULLET: {
+            Recorder::BodyFlagRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle)) return false;
+            world.getBody(record.handle).setBullet(record.value != 0);
+            return true;
+        }
+        case Recorder::RecordType::WAKE_BODY: {
+            BodyHandle handle;
+            if (!readPayload(payload, size, handle) || !world.getBodies().contains(handle)) return false;
+            world.getBody(handle).wake();
+            return true;
+        }
+        case Recorder::RecordType::ADD_FORCE: {
+            Recorder::ForceRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle) ||
+                record.type >= static_cast<std::uint32_t>(ForceType::CUSTOM)) return false;
+            ForceDef force{static_cast<ForceType>(record.type), record.vector, record.coefficient, record.damping};
+            world.getBody(record.handle).addForce(force);
+            return true;
+        }
+        case Recorder::RecordType::REMOVE_FORCES: {
+            Recorder::BodyFlagRecord record;
+            if (!readPayload(payload, size, record) || !world.getBodies().contains(record.handle) ||
+                record.value > static_cast<std::uint32_t>(ForceType::CUSTOM)) return false;
+            world.getBody(record.handle).removeForcesByType(static_cast<ForceType>(record.value));
+            return true;
+        }
+        case Recorder::RecordType::SPAWN_LIQUID: {
+            Recorder::SpawnRecord record;
+            if (!readPayload(payload, size, record)) return false;
+            world.spawnLiquidObjects(record.position, record.count);
+            return true;
+        }
+        case Recorder::RecordType::SET_GRAVITY: {
+            sf::Vector2f gravity;
+            if (!readPayload(payload, size, gravity)) return false;
+            world.setGravity(gravity);
+            return true;
+        }
+        case Recorder::RecordType::SET_LIQUID_DENSITY: {
+            float density;
+            if (!readPayload(payload, size, density)) return false;
+            world.setLiquidDensity(density);
+            return true;
+        }
+        case Recorder::RecordType::SET_LIQUID_MODEL: {
+            std::uint32_t model;
+            if (!readPayload(payload, size, model) || model > static_cast<std::uint32_t>(LiquidModel::SPH)) return false;
+            world.setLiquidModel(static_cast<LiquidModel>(model));
+            return true;
+        }
+        case Recorder::RecordType::SET_LIQUID_CAPACITY: {
+            std::uint64_t capacity;
+            if (!readPayload(payload, size, capacity)) return false;
+            world.setLiquidCapacity(static_cast<size_t>(capacity));
+            return true;
+        }
+        case Recorder::RecordType::SET_BROAD_PHASE: {
+            std::uint32_t type;
+            if (!readPayload(payload, size, type) ||
+                type > static_cast<std::uint32_t>(BroadPhaseType::SPATIAL_HASH)) return false;
+            world.setBroadPhase(static_cast<BroadPhaseType>(type));
+            return true;
+        }
+        case Recorder::RecordType::SET_BOUNDS: {
+            sf::Vector2f bounds;
+            if (!readPayload(payload, size, bounds)) return false;
+            world.setBounds(bounds.x, bounds.y);
+            return true;
+        }
+        case Recorder::RecordType::SET_WORLD_BOUNDS: {
+            sf::FloatRect bounds;
+            if (!readPayload(payload, size, bounds)) return false;
+            world.setBounds(bounds);
+            return true;
+        }
+        case Recorder::RecordType::SET_WALLS: {
+            std::uint32_t enabled;
+            if (!readPayload(payload, size, enabled)) return false;
+            world.setWallsEnabled(enabled != 0);
+            return true;
+        }
+        case Recorder::RecordType::SET_INTEGRATION_SCHEME: {
+            std::uint32_t scheme;
+            if (!readPayload(payload, size, scheme) ||
+                scheme > static_cast<std::uint32_t>(IntegrationScheme::VELOCITY_VERLET)) return false;
+            world.setIntegrationScheme(static_cast<IntegrationScheme>(scheme));
+            return true;
+        }
+        case Recorder::RecordType::SET_SLEEPING: {
+            std::uint32_t enabled;
+            if (!readPayload(payload, size, enabled)) return false;
+            world.setSleepingEnabled(enabled != 0);
+            return true;
+        }
+        case Recorder::RecordType::SET_SLEEP_THRESHOLDS: {
+            Recorder::SleepThresholdRecord record;
+            if (!readPayload(payload, size, record)) return false;
+            world.setSleepThresholds(record.velocity, record.time);
+            return true;
+        }
+        case Recorder::RecordType::SET_SOLVER_ITERATIONS: {
+            std::int32_t iterations;
+            if (!readPayload(payload, size, iterations)) return false;
+            world.setSolverIterations(iterations);
+            return true;
+        }
+        case Recorder::RecordType::SET_WARM_STARTING: {
+            std::uint32_t enabled;
+            if (!readPayload(payload, size, enabled)) return false;
+            world.setWarmStarting(enabled != 0);
+            return true;
+        }
+        case Recorder::RecordType::SET_CONTINUOUS_COLLISION: {
+            std::uint32_t enabled;
+            if (!readPayload(payload, size, enabled)) return false;
+            world.setContinuousCollision(enabled != 0);
+            return true;
+        }
+        case Recorder::RecordType::SET_STEP_RATE: {
+            float stepsPerSecond;
+            if (!readPayload(payload, size, stepsPerSecond)) return false;
+            world.setStepRate(stepsPerSecond);
+            return true;
+        }
+        case Recorder::RecordType::SET_DETERMINISTIC: {
+            std::uint32_t enabled;
+            if (!readPayload(payload, size, enabled)) return false;
+            world.setDeterministic(enabled != 0);
+            return true;
+        }
+        case Recorder::RecordType::SET_SEED: {
+            std::uint32_t seed;
+            if (!readPayload(payload, size, seed)) return false;
+            world.setSeed(seed);
+            return true;
+        }
+        case Recorder::RecordType::CLEAR:
+            world.clear();
+            return true;
+        case Recorder::RecordType::SETTING: {
+            Recorder::SettingRecord record;
+            if (!readPayload(payload, size, record) || size != sizeof(record) + record.keyLength) return false;
+            settings[std::string(payload + sizeof(record), record.keyLength)] = record.value;
+            return true;
+        }
+        default:
+            // END, or a record type from a newer build.
+            return true;
+    }
+}
+
+bool Replay::restoreKeyframe(PhysicsWorld& world, const Entry& entry) {
+    if (entry.size < sizeof(Recorder::KeyframeHeader)) {
+        return false;
+    }
+    Snapshot snapshot;
+    const char* begin = entry.payload + sizeof(Recorder::KeyframeHeader);
+    return snapshot.open(std::vector<char>(begin, entry.payload + entry.size)) && snapshot.restore(world);
+}
@@ -0,0 +1,111 @@
+#include "SatKernels.hpp"
+#include "CpuFeatures.hpp"
+#include <algorithm>
+#include <limits>
+#if defined(PHYSICS_SAT_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace SatKernels {
+
+void projectScalar(const sf::Vector2f* vertices, size_t vertexCount,
+                   const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs) {
+    for (size_t a = 0; a < axisCount; a++) {
+        float lo = std::numeric_limits<float>::max();
+        float hi = std::numeric_limits<float>::lowest();
+        for (size_t i = 0; i < vertexCount; i++) {
+            float proj = vertices[i].x * axisX[a] + vertices[i].y * axisY[a];
+            lo = std::min(lo, proj);
+            hi = std::max(hi, proj);
+        }
+        mins[a] = lo;
+        maxs[a] = hi;
+    }
+}
+
+#if defined(PHYSICS_SAT_SSE)
+void projectSse(const sf::Vector2f* vertices, size_t vertexCount,
+                const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs) {
+    for (size_t a = 0; a < axisCount; a += 4) {
+        __m128 x4 = _mm_loadu_ps(axisX + a);
+        __m128 y4 = _mm_loadu_ps(axisY + a);
+        __m128 lo4 = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 hi4 = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < vertexCount; i++) {
+            __m128 proj = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(vertices[i].x), x4),
+                                     _mm_mul_ps(_mm_set1_ps(vertices[i].y), y4));
+            lo4 = _mm_min_ps(lo4, proj);
+            hi4 = _mm_max_ps(hi4, proj);
+        }
+        _mm_storeu_ps(mins + a, lo4);
+        _mm_storeu_ps(maxs + a, hi4);
+    }
+}
+#endif
+
+Kernel best() {
+    // Checked once: the CPU can't change under us.
+    static const Kernel kernel = available(Kernel::Avx2) ? Kernel::Avx2
+                               : available(Kernel::Sse) ? Kernel::Sse
+                               : Kernel::Scalar;
+    return kernel;
+}
+
+const char* name(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Sse: return "sse";
+        case Kernel::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+bool available(Kernel kernel) {
+    switch (kernel) {
+#if defined(PHYSICS_SAT_SSE)
+        case Kernel::Sse: return true;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2: return cpuHasAvx2();
+#endif
+        case Kernel::Scalar: return true;
+        default: return false;
+    }
+}
+
+void project(Kernel kernel, const sf::Vector2f* vertices, size_t vertexCount,
+             const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs) {
+    switch (available(kernel) ? kernel : Kernel::Scalar) {
+#if defined(PHYSICS_SAT_SSE)
+        case Kernel::Sse:
+            projectSse(vertices, vertexCount, axisX, axisY, axisCount, mins, maxs);
+            return;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2:
+            projectAvx2(vertices, vertexCount, axisX, axisY, axisCount, mins, maxs);
+            return;
+#endif
+        default:
+            projectScalar(vertices, vertexCount, axisX, axisY, axisCount, mins, maxs);
+    }
+}
+
+namespace {
+
+ProjectFn selectProject() {
+    switch (best()) {
+#if defined(PHYSICS_SAT_SSE)
+        case Kernel::Sse: return projectSse;
+#endif
+#if defined(PHYSICS_AVX2)
+        case Kernel::Avx2: return projectAvx2;
+#endif
+        default: return projectScalar;
+    }
+}
+
+}
+
+const ProjectFn bestProject = selectProject();
+
+}
@@ -0,0 +1,36 @@
+// Built with AVX2 enabled, unlike the rest of the library; only reached
+// through SatKernels' dispatch once the CPU is known to support it. Don't
+// call inline library functions here: an out-of-line copy compiled in this
+// file could be the one the linker keeps for every other caller.
+#include "SatKernels.hpp"
+#include <immintrin.h>
+#include <limits>
+
+namespace SatKernels {
+
+namespace {
+
+constexpr float HIGHEST = std::numeric_limits<float>::max();
+constexpr float LOWEST = std::numeric_limits<float>::lowest();
+
+}
+
+void projectAvx2(const sf::Vector2f* vertices, size_t vertexCount,
+                 const float* axisX, const float* axisY, size_t axisCount, float* mins, float* maxs) {
+    for (size_t a = 0; a < axisCount; a += 8) {
+        __m256 x8 = _mm256_loadu_ps(axisX + a);
+        __m256 y8 = _mm256_loadu_ps(axisY + a);
+        __m256 lo8 = _mm256_set1_ps(HIGHEST);
+        __m256 hi8 = _mm256_set1_ps(LOWEST);
+        for (size_t i = 0; i < vertexCount; i++) {
+            __m256 proj = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(vertices[i].x), x8),
+                                        _mm256_mul_ps(_mm256_set1_ps(vertices[i].y), y8));
+            lo8 = _mm256_min_ps(lo8, proj);
+            hi8 = _mm256_max_ps(hi8, proj);
+        }
+        _mm256_storeu_ps(mins + a, lo8);
+        _mm256_storeu_ps(maxs + a, hi8);
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#include "ShapeDef.hpp"
+#include <algorithm>
+#include <cmath>
+
+ShapeDef ShapeDef::polygon(const std::vector<sf::Vector2f>& worldVertices) {
+    ShapeDef def;
+    def.type = BodyShape::POLYGON;
+
+    // Work relative to the first vertex: far from the origin the cross
+    // products get large and the centroid loses precision.
+    sf::Vector2f origin = worldVertices[0];
+    float signedArea = 0;
+    sf::Vector2f centerOfMass(0, 0);
+    for (size_t i = 0; i < worldVertices.size(); ++i) {
+        sf::Vector2f current = worldVertices[i] - origin;
+        sf::Vector2f next = worldVertices[(i + 1) % worldVertices.size()] - origin;
+        float crossProduct = current.x * next.y - next.x * current.y;
+        signedArea += crossProduct;
+        centerOfMass += (current + next) * crossProduct;
+    }
+    signedArea /= 2;
+
+    if (signedArea != 0) {
+        centerOfMass = origin + centerOfMass / (6 * signedArea);
+    } else {
+        centerOfMass = origin;
+    }
+    def.centroid = centerOfMass;
+    def.area = std::abs(signedArea);
+
+    def.vertices.reserve(worldVertices.size());
+    for (const sf::Vector2f& v : worldVertices) {
+        def.vertices.push_back(v - centerOfMass);
+    }
+
+    // Second moment of area about the centroid, summed over the triangles
+    // (centroid, v[i], v[i+1]).
+    float secondMoment = 0;
+    size_t count = def.vertices.size();
+    for (size_t i = 0; i < count; ++i) {
+        sf::Vector2f a = def.vertices[i];
+        sf::Vector2f b = def.vertices[(i + 1) % count];
+        float crossProduct = a.x * b.y - b.x * a.y;
+        secondMoment += crossProduct * (a.x * a.x + a.y * a.y + a.x * b.x + a.y * b.y + b.x * b.x + b.y * b.y);
+    }
+    def.unitInertia = std::abs(secondMoment) / 12.0f;
+
+    def.normals.reserve(count);
+    def.bounds.min = def.bounds.max = def.vertices[0];
+    for (size_t i = 0; i < count; ++i) {
+        sf::Vector2f start = def.vertices[i];
+        sf::Vector2f edge = def.vertices[(i + 1) % count] - start;
+        sf::Vector2f normal(edge.y, -edge.x);
+        float length = std::sqrt(normal.x * normal.x + normal.y * normal.y);
+        if (length > 0) {
+            normal /= length;
+        }
+        // Either winding works: flip whichever normal points at the centroid.
+        if (normal.x * start.x + normal.y * start.y < 0) {
+            normal = -normal;
+        }
+        def.normals.push_back(normal);
+
+        def.bounds.min.x = std::min(def.bounds.min.x, start.x);
+        def.bounds.min.y = std::min(def.bounds.min.y, start.y);
+        def.bounds.max.x = std::max(def.bounds.max.x, start.x);
+        def.bounds.max.y = std::max(def.bounds.max.y, start.y);
+        def.boundingRadius = std::max(def.boundingRadius, std::sqrt(start.x * start.x + start.y * start.y));
+    }
+    return def;
+}
+
+ShapeDef ShapeDef::circle(float radius) {
+    ShapeDef def;
+    def.type = BodyShape::CIRCLE;
+    def.radius = radius;
+    def.area = 3.14159f * radius * radius;
+    def.unitInertia = 0.5f * def.area * radius * radius;
+    def.bounds.min = sf::Vector2f(-radius, -radius);
+    def.bounds.max = sf::Vector2f(radius, radius);
+    def.boundingRadius = radius;
+    return def;
+}
@@ -0,0 +1,806 @@
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "Logger.hpp"
+#include "Profiler.hpp"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::uint32_t fourCC(const char (&name)[5]) {
+    return static_cast<std::uint32_t>(name[0]) | static_cast<std::uint32_t>(name[1]) << 8 |
+           static_cast<std::uint32_t>(name[2]) << 16 | static_cast<std::uint32_t>(name[3]) << 24;
+}
+
+constexpr std::uint32_t MAGIC = fourCC("PSNP");
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+constexpr std::uint32_t WORLD_SECTION = fourCC("WRLD");
+constexpr std::uint32_t RNG_SECTION = fourCC("RNG ");
+constexpr std::uint32_t SHAPE_SECTION = fourCC("SHAP");
+constexpr std::uint32_t BODY_SECTION = fourCC("BODY");
+constexpr std::uint32_t ID_SECTION = fourCC("IDS ");
+constexpr std::uint32_t FORCE_SECTION = fourCC("FARN");
+// Version 1 forces: a count per body, then {type, x, y} records, all of them
+// gravity. Each body carried its own copy of world gravity back then.
+constexpr std::uint32_t LEGACY_FORCE_SECTION = fourCC("FORC");
+constexpr std::uint32_t PARTICLE_SECTION = fourCC("PART");
+constexpr std::uint32_t PAIR_SECTION = fourCC("PAIR");
+constexpr std::uint32_t SETTINGS_SECTION = fourCC("APPS");
+// The bounds' origin came later than their size, which the world record
+// holds; files from before version 3 have the origin at zero.
+constexpr std::uint32_t BOUNDS_SECTION = fourCC("BNDS");
+// One BodyType byte per body; files from before version 4 have only
+// dynamic bodies.
+constexpr std::uint32_t TYPE_SECTION = fourCC("TYPE");
+
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+};
+
+struct SectionHeader {
+    std::uint32_t tag;
+    std::uint32_t count;   // number of records, meaning depends on the tag
+    std::uint64_t size;    // payload bytes, a multiple of 8
+};
+
+// WorldRecord::flags bits.
+constexpr std::uint32_t DETERMINISTIC = 1u << 0;
+constexpr std::uint32_t SLEEPING = 1u << 1;
+constexpr std::uint32_t CONTINUOUS_COLLISION = 1u << 2;
+constexpr std::uint32_t WARM_STARTING = 1u << 3;
+constexpr std::uint32_t VELOCITY_VERLET = 1u << 4;
+constexpr std::uint32_t NO_WALLS = 1u << 5;
+
+struct WorldRecord {
+    float width, height;
+    float gravityX, gravityY;
+    float fixedDt, accumulator;
+    float sleepVelocity, timeToSleep;
+    std::int32_t maxSubSteps, solverIterations;
+    std::uint32_t seed, flags;
+    std::uint64_t stepCount, stepHash;
+    std::uint32_t broadPhase, liquidModel;
+    float kernelRadius, restDensity, stiffness, viscosity;
+    float particleDensity;
+    std::uint32_t particleColor;
+};
+
+struct ShapeRecord {
+    std::uint32_t type;
+    std::uint32_t vertexCount;   // followed by that many vertices, then as many normals
+    float radius, area, unitInertia, boundingRadius;
+    float centroidX, centroidY;
+    float minX, minY, maxX, maxY;
+};
+
+struct BoundsRecord {
+    float left, top, width, height;
+};
+
+struct ForceRecord {
+    std::uint32_t body;
+    std::uint32_t type;
+    float x, y;
+    float coefficient, damping;
+};
+
+struct LegacyForceRecord {
+    std::uint32_t type;
+    float x, y;
+};
+
+struct PairRecord {
+    std::uint32_t idA, idB, wall;
+    std::uint32_t generationA, generationB;
+    std::int32_t pointCount;
+    std::uint64_t lastStep;
+    struct {
+        std::uint32_t feature;
+        float normalImpulse, tangentImpulse;
+    } points[2];
+};
+
+struct SettingRecord {
+    std::uint32_t keyLength;   // followed by the key's characters
+    float value;
+};
+
+// Per-body floats, in file order. Radius is left out: it comes with the shape.
+std::vector<float> BodyStore::* const BODY_FLOATS[] = {
+    &BodyStore::posX, &BodyStore::posY, &BodyStore::prevX, &BodyStore::prevY,
+    &BodyStore::velX, &BodyStore::velY, &BodyStore::accX, &BodyStore::accY,
+    &BodyStore::angle, &BodyStore::prevAngle, &BodyStore::angularVel, &BodyStore::torque,
+    &BodyStore::mass, &BodyStore::invMass, &BodyStore::inertia, &BodyStore::invInertia,
+    &BodyStore::density, &BodyStore::sleepTime
+};
+constexpr size_t BODY_FLOAT_COUNT = sizeof(BODY_FLOATS) / sizeof(BODY_FLOATS[0]);
+
+// Density, pressure and acceleration are recomputed every substep.
+std::vector<float> ParticleSystem::* const PARTICLE_FLOATS[] = {
+    &ParticleSystem::posX, &ParticleSystem::posY, &ParticleSystem::prevX, &ParticleSystem::prevY,
+    &ParticleSystem::velX, &ParticleSystem::velY, &ParticleSystem::radius,
+    &ParticleSystem::mass, &ParticleSystem::invMass, &ParticleSystem::age, &ParticleSystem::lifetime
+};
+constexpr size_t PARTICLE_FLOAT_COUNT = sizeof(PARTICLE_FLOATS) / sizeof(PARTICLE_FLOATS[0]);
+
+size_t padded(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+std::uint32_t packColor(sf::Color c) {
+    return static_cast<std::uint32_t>(c.r) << 24 | static_cast<std::uint32_t>(c.g) << 16 |
+           static_cast<std::uint32_t>(c.b) << 8 | c.a;
+}
+
+sf::Color unpackColor(std::uint32_t c) {
+    return sf::Color(static_cast<sf::Uint8>(c >> 24), static_cast<sf::Uint8>(c >> 16),
+                     static_cast<sf::Uint8>(c >> 8), static_cast<sf::Uint8>(c));
+}
+
+class Writer {
+public:
+    explicit Writer(std::vector<char>& out) : out(out) {
+        FileHeader header{MAGIC, BYTE_ORDER_MARK, Snapshot::VERSION, 0};
+        append(&header, sizeof(header));
+    }
+
+    void beginSection(std::uint32_t tag, size_t count) {
+        sectionStart = out.size();
+        SectionHeader header{tag, static_cast<std::uint32_t>(count), 0};
+        append(&header, sizeof(header));
+    }
+
+    void endSection() {
+        std::uint64_t size = out.size() - sectionStart - sizeof(SectionHeader);
+        std::memcpy(out.data() + sectionStart + offsetof(SectionHeader, size), &size, sizeof(size));
+        sectionCount++;
+        std::memcpy(out.data() + offsetof(FileHeader, sectionCount), &sectionCount, sizeof(sectionCount));
+    }
+
+    // Every array starts on an 8-byte boundary.
+    template <typename T>
+    void array(const T* values, size_t n) {
+        append(values, n * sizeof(T));
+        out.resize(padded(out.size()), 0);
+    }
+
+    template <typename T>
+    void value(const T& v) { array(&v, 1); }
+
+private:
+    std::vector<char>& out;
+    size_t sectionStart = 0;
+    std::uint32_t sectionCount = 0;
+
+    void append(const void* bytes, size_t n) {
+        const char* p = static_cast<const char*>(bytes);
+        out.insert(out.end(), p, p + n);
+    }
+};
+
+// Bounds-checked walk over a section payload. Returns pointers into the
+// snapshot's bytes; callers memcpy out of them.
+class Reader {
+public:
+    Reader(const char* payload, size_t size) : p(payload), end(payload + size) {}
+
+    template <typename T>
+    const char* array(size_t n) {
+        if (!ok || n > static_cast<size_t>(end - p) / sizeof(T)) {
+            ok = false;
+            return nullptr;
+        }
+        const char* result = p;
+        p += std::min(padded(n * sizeof(T)), static_cast<size_t>(end - p));
+        return result;
+    }
+
+    template <typename T>
+    bool value(T& out) {
+        const char* bytes = array<T>(1);
+        if (bytes) std::memcpy(&out, bytes, sizeof(T));
+        return bytes != nullptr;
+    }
+
+    bool ok = true;
+
+private:
+    const char* p;
+    const char* end;
+};
+
+template <typename T>
+void copyArray(std::vector<T>& destination, const char* source, size_t n) {
+    if (n > 0) std::memcpy(destination.data(), source, n * sizeof(T));
+}
+
+}
+
+Snapshot::~Snapshot() {
+    close();
+}
+
+std::vector<char> Snapshot::capture(const PhysicsWorld& world, const Settings& appSettings) {
+    PROFILE_ZONE("Snapshot capture");
+    const BodyStore& bodies = world.bodies;
+    const ParticleSystem& particles = world.particles;
+    const ContactSolver& solver = world.solver;
+    size_t n = bodies.size();
+    size_t m = particles.size();
+
+    std::vector<char> out;
+    out.reserve(4096 + n * (BODY_FLOAT_COUNT * 4 + 40) + m * PARTICLE_FLOAT_COUNT * 4 +
+                solver.pairs.size() * sizeof(PairRecord));
+    Writer writer(out);
+
+    WorldRecord record{};
+    record.width = world.bounds.width;
+    record.height = world.bounds.height;
+    record.gravityX = world.gravity.x;
+    record.gravityY = world.gravity.y;
+    record.fixedDt = world.fixedDt;
+    record.accumulator = world.accumulator;
+    record.sleepVelocity = world.sleepVelocity;
+    record.timeToSleep = world.timeToSleep;
+    record.maxSubSteps = world.maxSubSteps;
+    record.solverIterations = solver.getIterations();
+    record.seed = world.seed;
+    record.flags = (world.deterministic ? DETERMINISTIC : 0u) | (world.sleepingEnabled ? SLEEPING : 0u) |
+                   (world.continuousCollision ? CONTINUOUS_COLLISION : 0u) |
+                   (solver.isWarmStarting() ? WARM_STARTING : 0u) |
+                   (world.integrationScheme == IntegrationScheme::VELOCITY_VERLET ? VELOCITY_VERLET : 0u) |
+                   (world.wallsEnabled ? 0u : NO_WALLS);
+    record.stepCount = world.stepCount;
+    record.stepHash = world.stepHash;
+    record.broadPhase = static_cast<std::uint32_t>(world.getBroadPhaseType());
+    record.liquidModel = static_cast<std::uint32_t>(particles.getModel());
+    const SPHSettings& sph = particles.getSPHSettings();
+    record.kernelRadius = sph.kernelRadius;
+    record.restDensity = sph.restDensity;
+    record.stiffness = sph.stiffness;
+    record.viscosity = sph.viscosity;
+    record.particleDensity = particles.particleDensity;
+    record.particleColor = packColor(particles.getColor());
+    writer.beginSection(WORLD_SECTION, 1);
+    writer.value(record);
+    writer.endSection();
+
+    BoundsRecord boundsRecord{world.bounds.left, world.bounds.top, world.bounds.width, world.bounds.height};
+    writer.beginSection(BOUNDS_SECTION, 1);
+    writer.value(boundsRecord);
+    writer.endSection();
+
+    // The generator's own text format is the only portable way to get at its state.
+    std::ostringstream rngState;
+    rngState << world.rng;
+    std::string rngText = rngState.str();
+    writer.beginSection(RNG_SECTION, rngText.size());
+    writer.array(rngText.data(), rngText.size());
+    writer.endSection();
+
+    std::map<const ShapeDef*, std::uint32_t> shapeIndices;
+    std::vector<const ShapeDef*> shapeList;
+    std::vector<std::uint32_t> shapeIndex(n);
+    for (size_t i = 0; i < n; i++) {
+        auto inserted = shapeIndices.emplace(bodies.shapes[i].get(), static_cast<std::uint32_t>(shapeList.size()));
+        if (inserted.second) shapeList.push_back(bodies.shapes[i].get());
+        shapeIndex[i] = inserted.first->second;
+    }
+    writer.beginSection(SHAPE_SECTION, shapeList.size());
+    for (const ShapeDef* def : shapeList) {
+        ShapeRecord shape{};
+        shape.type = static_cast<std::uint32_t>(def->type);
+        shape.vertexCount = static_cast<std::uint32_t>(def->vertices.size());
+        shape.radius = def->radius;
+        shape.area = def->area;
+        shape.unitInertia = def->unitInertia;
+        shape.boundingRadius = def->boundingRadius;
+        shape.centroidX = def->centroid.x;
+        shape.centroidY = def->centroid.y;
+        shape.minX = def->bounds.min.x;
+        shape.minY = def->bounds.min.y;
+        shape.maxX = def->bounds.max.x;
+        shape.maxY = def->bounds.max.y;
+        writer.value(shape);
+        writer.array(def->vertices.data(), def->vertices.size());
+        writer.array(def->normals.data(), def->normals.size());
+    }
+    writer.endSection();
+
+    std::vector<std::uint32_t> colors(n);
+    for (size_t i = 0; i < n; i++) {
+        colors[i] = packColor(bodies.colors[i]);
+    }
+    writer.beginSection(BODY_SECTION, n);
+    for (auto member : BODY_FLOATS) {
+        writer.array((bodies.*member).data(), n);
+    }
+    writer.array(bodies.indexToId.data(), n);
+    writer.array(shapeIndex.data(), n);
+    writer.array(colors.data(), n);
+    writer.array(bodies.sleepGroup.data(), n);
+    writer.array(bodies.awake.data(), n);
+    writer.array(bodies.bullet.data(), n);
+    writer.endSection();
+
+    writer.beginSection(TYPE_SECTION, n);
+    writer.array(bodies.type.data(), n);
+    writer.endSection();
+
+    writer.beginSection(ID_SECTION, bodies.generations.size());
+    writer.value(static_cast<std::uint32_t>(bodies.freeIds.size()));
+    writer.array(bodies.generations.data(), bodies.generations.size());
+    writer.array(bodies.freeIds.data(), bodies.freeIds.size());
+    writer.endSection();
+
+    std::vector<ForceRecord> forces;
+    for (const ForceArena::Entry& entry : bodies.forces.getEntries()) {
+        const ForceDef& f = entry.force;
+        if (f.type == ForceType::CUSTOM) {
+            LOG(LogCategory::WORLD, LogLevel::WARNING) << "Snapshot skips a custom force on body " << entry.body;
+            continue;
+        }
+        forces.push_back({entry.body, static_cast<std::uint32_t>(f.type), f.vector.x, f.vector.y, f.coefficient, f.damping});
+    }
+    writer.beginSection(FORCE_SECTION, forces.size());
+    writer.array(forces.data(), forces.size());
+    writer.endSection();
+
+    writer.beginSection(PARTICLE_SECTION, m);
+    writer.value(static_cast<std::uint64_t>(particles.capacity()));
+    for (auto member : PARTICLE_FLOATS) {
+        writer.array((particles.*member).data(), m);
+    }
+    writer.endSection();
+
+    std::vector<PairRecord> pairs;
+    pairs.reserve(solver.pairs.size());
+    for (const auto& entry : solver.pairs) {
+        PairRecord pair{};
+        pair.idA = entry.first.idA;
+        pair.idB = entry.first.idB;
+        pair.wall = entry.first.wall;
+        pair.generationA = entry.second.generationA;
+        pair.generationB = entry.second.generationB;
+        pair.pointCount = entry.second.pointCount;
+        pair.lastStep = entry.second.lastStep;
+        for (int k = 0; k < 2; k++) {
+            pair.points[k].feature = entry.second.points[k].feature;
+            pair.points[k].normalImpulse = entry.second.points[k].normalImpulse;
+            pair.points[k].tangentImpulse = entry.second.points[k].tangentImpulse;
+        }
+        pairs.push_back(pair);
+    }
+    writer.beginSection(PAIR_SECTION, pairs.size());
+    writer.value(solver.stepCount);
+    writer.array(pairs.data(), pairs.size());
+    writer.endSection();
+
+    writer.beginSection(SETTINGS_SECTION, appSettings.size());
+    for (const auto& setting : appSettings) {
+        writer.value(SettingRecord{static_cast<std::uint32_t>(setting.first.size()), setting.second});
+        writer.array(setting.first.data(), setting.first.size());
+    }
+    writer.endSection();
+
+    return out;
+}
+
+bool Snapshot::write(const std::string& path, const std::vector<char>& bytes) {
+    PROFILE_ZONE("Snapshot write");
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not write snapshot to " << temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        // Windows refuses to rename over an existing file.
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not replace snapshot " << path;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::future<bool> Snapshot::saveAsync(const PhysicsWorld& world, const std::string& path, const Settings& appSettings) {
+    std::vector<char> bytes = capture(world, appSettings);
+    return std::async(std::launch::async, [path, bytes = std::move(bytes)]() {
+        return write(path, bytes);
+    });
+}
+
+bool Snapshot::open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not open snapshot " << path;
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not open snapshot " << path;
+        return false;
+    }
+    struct stat info;
+    void* address = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Could not map snapshot " << path;
+        return false;
+    }
+    mapped = address;
+    data = static_cast<const char*>(address);
+    size = static_cast<size_t>(info.st_size);
+#endif
+    if (!parse()) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << path << " is not a readable snapshot";
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool Snapshot::open(std::vector<char> bytes) {
+    close();
+    buffer = std::move(bytes);
+    data = buffer.data();
+    size = buffer.size();
+    if (!parse()) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Snapshot buffer is not readable";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Snapshot::close() {
+#if !defined(_WIN32)
+    if (mapped) {
+        munmap(mapped, size);
+    }
+#endif
+    mapped = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    sections.clear();
+    settings.clear();
+    version = 0;
+}
+
+bool Snapshot::parse() {
+    FileHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC) return false;
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Snapshot was written on a machine with the other byte order";
+        return false;
+    }
+    version = header.version;
+    if (header.version > VERSION) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Snapshot version " << header.version
+                                                 << " is newer than this build reads (" << VERSION << ")";
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    for (std::uint32_t s = 0; s < header.sectionCount; s++) {
+        SectionHeader section;
+        if (size - offset < sizeof(section)) return false;
+        std::memcpy(&section, data + offset, sizeof(section));
+        offset += sizeof(section);
+        if (section.size > size - offset) return false;
+        sections.push_back({section.tag, section.count, data + offset, static_cast<size_t>(section.size)});
+        offset += static_cast<size_t>(section.size);
+    }
+
+    if (const Section* section = findSection(SETTINGS_SECTION)) {
+        Reader reader(section->payload, section->size);
+        for (std::uint32_t i = 0; i < section->count; i++) {
+            SettingRecord record;
+            if (!reader.value(record)) return false;
+            const char* key = reader.array<char>(record.keyLength);
+            if (!key) return false;
+            settings[std::string(key, record.keyLength)] = record.value;
+        }
+    }
+    return findSection(WORLD_SECTION) != nullptr;
+}
+
+const Snapshot::Section* Snapshot::findSection(std::uint32_t tag) const {
+    for (const Section& section : sections) {
+        if (section.tag == tag) return &section;
+    }
+    return nullptr;
+}
+
+bool Snapshot::restore(PhysicsWorld& world) const {
+    PROFILE_ZONE("Snapshot restore");
+    if (!isOpen()) return false;
+    auto reject = [](const char* reason) {
+        LOG(LogCategory::WORLD, LogLevel::ERROR) << "Snapshot rejected: " << reason;
+        return false;
+    };
+    auto reader = [this](std::uint32_t tag) {
+        const Section* section = findSection(tag);
+        return section ? Reader(section->payload, section->size) : Reader(nullptr, 0);
+    };
+    auto countOf = [this](std::uint32_t tag) -> size_t {
+        const Section* section = findSection(tag);
+        return section ? section->count : 0;
+    };
+
+    // Decode and check everything before touching the world.
+    WorldRecord record;
+    Reader worldReader = reader(WORLD_SECTION);
+    if (!worldReader.value(record)) return reject("world settings truncated");
+
+    BoundsRecord boundsRecord{0.0f, 0.0f, record.width, record.height};
+    if (version >= 3) {
+        Reader boundsReader = reader(BOUNDS_SECTION);
+        if (!boundsReader.value(boundsRecord)) return reject("bounds truncated");
+    }
+
+    std::mt19937 rng(record.seed);
+    if (const Section* section = findSection(RNG_SECTION)) {
+        std::istringstream rngState(std::string(section->payload, std::min<size_t>(section->count, section->size)));
+        rngState >> rng;
+        if (!rngState) return reject("bad RNG state");
+    }
+
+    std::vector<ShapeDef> shapeDefs(countOf(SHAPE_SECTION));
+    Reader shapeReader = reader(SHAPE_SECTION);
+    for (ShapeDef& def : shapeDefs) {
+        ShapeRecord shape;
+        if (!shapeReader.value(shape)) return reject("shapes truncated");
+        const char* vertices = shapeReader.array<sf::Vector2f>(shape.vertexCount);
+        const char* normals = shapeReader.array<sf::Vector2f>(shape.vertexCount);
+        if (!shapeReader.ok || shape.type > static_cast<std::uint32_t>(BodyShape::POLYGON)) return reject("bad shape");
+        def.type = static_cast<BodyShape>(shape.type);
+        def.radius = shape.radius;
+        def.vertices.resize(shape.vertexCount);
+        def.normals.resize(shape.vertexCount);
+        copyArray(def.vertices, vertices, shape.vertexCount);
+        copyArray(def.normals, normals, shape.vertexCount);
+        def.centroid = sf::Vector2f(shape.centroidX, shape.centroidY);
+        def.area = shape.area;
+        def.unitInertia = shape.unitInertia;
+        def.bounds.min = sf::Vector2f(shape.minX, shape.minY);
+        def.bounds.max = sf::Vector2f(shape.maxX, shape.maxY);
+        def.boundingRadius = shape.boundingRadius;
+    }
+
+    size_t n = countOf(BODY_SECTION);
+    Reader bodyReader = reader(BODY_SECTION);
+    const char* bodyFloats[BODY_FLOAT_COUNT];
+    for (const char*& array : bodyFloats) {
+        array = bodyReader.array<float>(n);
+    }
+    const char* indexToId = bodyReader.array<std::uint32_t>(n);
+    const char* shapeIndex = bodyReader.array<std::uint32_t>(n);
+    const char* colors = bodyReader.array<std::uint32_t>(n);
+    const char* sleepGroup = bodyReader.array<std::uint32_t>(n);
+    const char* awake = bodyReader.array<std::uint8_t>(n);
+    const char* bullet = bodyReader.array<std::uint8_t>(n);
+    if (!bodyReader.ok) return reject("bodies truncated");
+
+    std::vector<BodyType> types(n, BodyType::DYNAMIC);
+    if (version >= 4) {
+        Reader typeReader = reader(TYPE_SECTION);
+        const char* typeBytes = typeReader.array<BodyType>(n);
+        if (!typeReader.ok || countOf(TYPE_SECTION) != n) return reject("body types truncated");
+        copyArray(types, typeBytes, n);
+        for (BodyType type : types) {
+            if (type > BodyType::KINEMATIC) return reject("bad body type");
+        }
+    }
+
+    size_t idCount = countOf(ID_SECTION);
+    std::uint32_t freeCount = 0;
+    Reader idReader = reader(ID_SECTION);
+    idReader.value(freeCount);
+    const char* generations = idReader.array<std::uint32_t>(idCount);
+    const char* freeIds = idReader.array<std::uint32_t>(freeCount);
+    if (n > 0 && !idReader.ok) return reject("body ids truncated");
+
+    // Every id must be either live exactly once or free exactly once.
+    std::vector<std::uint32_t> ids(n), shapeIndices(n), freeList(freeCount);
+    copyArray(ids, indexToId, n);
+    copyArray(shapeIndices, shapeIndex, n);
+    copyArray(freeList, freeIds, freeCount);
+    std::vector<std::uint8_t> seen(idCount, 0);
+    for (size_t i = 0; i < n; i++) {
+        if (shapeIndices[i] >= shapeDefs.size()) return reject("body refers to a missing shape");
+        if (ids[i] >= idCount || seen[ids[i]]++) return reject("bad body id");
+    }
+    for (std::uint32_t id : freeList) {
+        if (id >= idCount || seen[id]) return reject("bad free id");
+        seen[id] = 2;
+    }
+    if (n + freeCount != idCount) return reject("body ids don't add up");
+
+    std::vector<ForceRecord> forces(countOf(FORCE_SECTION));
+    if (version < 2) {
+        // World gravity now applies to every body by itself; keep whatever a
+        // body's own gravity copies added up to beyond it as an extra force.
+        if (!findSection(LEGACY_FORCE_SECTION)) return reject("forces missing");
+        forces.clear();
+        std::vector<std::uint32_t> forceCounts(n);
+        std::vector<LegacyForceRecord> legacy(countOf(LEGACY_FORCE_SECTION));
+        Reader forceReader = reader(LEGACY_FORCE_SECTION);
+        const char* counts = forceReader.array<std::uint32_t>(n);
+        const char* records = forceReader.array<LegacyForceRecord>(legacy.size());
+        if (!forceReader.ok) return reject("forces truncated");
+        copyArray(forceCounts, counts, n);
+        copyArray(legacy, records, legacy.size());
+        size_t next = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (forceCounts[i] > legacy.size() - next) return reject("force counts don't add up");
+            sf::Vector2f total;
+            for (std::uint32_t k = 0; k < forceCounts[i]; k++, next++) {
+                if (legacy[next].type != static_cast<std::uint32_t>(ForceType::GRAVITY)) return reject("bad force");
+                total += sf::Vector2f(legacy[next].x, legacy[next].y);
+            }
+            sf::Vector2f extra = total - sf::Vector2f(record.gravityX, record.gravityY);
+            if (extra != sf::Vector2f()) {
+                forces.push_back({ids[i], static_cast<std::uint32_t>(ForceType::GRAVITY), extra.x, extra.y, 0.0f, 0.0f});
+            }
+        }
+        if (next != legacy.size()) return reject("force counts don't add up");
+    } else if (!findSection(FORCE_SECTION)) {
+        return reject("forces missing");
+    } else if (!forces.empty()) {
+        Reader forceReader = reader(FORCE_SECTION);
+        const char* records = forceReader.array<ForceRecord>(forces.size());
+        if (!forceReader.ok) return reject("forces truncated");
+        copyArray(forces, records, forces.size());
+        for (const ForceRecord& force : forces) {
+            if (force.body >= idCount || seen[force.body] != 1 || force.type >= static_cast<std::uint32_t>(ForceType::CUSTOM)) {
+                return reject("bad force");
+            }
+        }
+    }
+
+    size_t m = countOf(PARTICLE_SECTION);
+    std::uint64_t particleCapacity = world.particles.capacity();
+    const char* particleFloats[PARTICLE_FLOAT_COUNT] = {};
+    if (findSection(PARTICLE_SECTION)) {
+        Reader particleReader = reader(PARTICLE_SECTION);
+        particleReader.value(particleCapacity);
+        for (const char*& array : particleFloats) {
+            array = particleReader.array<float>(m);
+        }
+        if (!particleReader.ok || m > particleCapacity) return reject("particles truncated");
+        if (particleCapacity > ParticleSystem::MAX_CAPACITY) return reject("particle capacity too large");
+    }
+
+    std::uint64_t solverStep = 0;
+    std::vector<PairRecord> pairs(countOf(PAIR_SECTION));
+    if (findSection(PAIR_SECTION)) {
+        Reader pairReader = reader(PAIR_SECTION);
+        pairReader.value(solverStep);
+        const char* records = pairReader.array<PairRecord>(pairs.size());
+        if (!pairReader.ok) return reject("contact cache truncated");
+        copyArray(pairs, records, pairs.size());
+    }
+
+    // Everything checks out; replace the world.
+    world.clear();
+    world.bounds = sf::FloatRect(boundsRecord.left, boundsRecord.top, boundsRecord.width, boundsRecord.height);
+    world.wallsEnabled = (record.flags & NO_WALLS) == 0;
+    world.gravity = sf::Vector2f(record.gravityX, record.gravityY);
+    world.fixedDt = record.fixedDt;
+    world.accumulator = record.accumulator;
+    world.sleepVelocity = record.sleepVelocity;
+    world.timeToSleep = record.timeToSleep;
+    world.maxSubSteps = record.maxSubSteps;
+    world.seed = record.seed;
+    world.rng = rng;
+    world.deterministic = (record.flags & DETERMINISTIC) != 0;
+    world.sleepingEnabled = (record.flags & SLEEPING) != 0;
+    world.continuousCollision = (record.flags & CONTINUOUS_COLLISION) != 0;
+    world.integrationScheme = (record.flags & VELOCITY_VERLET) ? IntegrationScheme::VELOCITY_VERLET
+                                                               : IntegrationScheme::SEMI_IMPLICIT_EULER;
+    world.stepCount = record.stepCount;
+    world.stepHash = record.stepHash;
+    world.setBroadPhase(static_cast<BroadPhaseType>(record.broadPhase));
+    world.solver.setIterations(record.solverIterations);
+    world.solver.setWarmStarting((record.flags & WARM_STARTING) != 0);
+
+    ParticleSystem& particles = world.particles;
+    particles.setGravity(world.gravity);
+    particles.setModel(static_cast<LiquidModel>(record.liquidModel));
+    particles.setSPHSettings({record.kernelRadius, record.restDensity, record.stiffness, record.viscosity});
+    particles.particleDensity = record.particleDensity;
+    particles.setColor(unpackColor(record.particleColor));
+    particles.setCapacity(static_cast<size_t>(particleCapacity));
+    particles.count = m;
+    for (size_t k = 0; k < PARTICLE_FLOAT_COUNT; k++) {
+        copyArray(particles.*PARTICLE_FLOATS[k], particleFloats[k], m);
+    }
+
+    BodyStore& bodies = world.bodies;
+    std::vector<ShapeRef> shapes;
+    shapes.reserve(shapeDefs.size());
+    for (ShapeDef& def : shapeDefs) {
+        shapes.push_back(bodies.intern(std::move(def)));
+    }
+    std::vector<std::uint32_t> packedColors(n);
+    copyArray(packedColors, colors, n);
+    for (size_t i = 0; i < n; i++) {
+        bodies.create(shapes[shapeIndices[i]], sf::Vector2f(), 0.0f, sf::Vector2f(), unpackColor(packedColors[i]), 0.0f);
+    }
+    for (size_t k = 0; k < BODY_FLOAT_COUNT; k++) {
+        copyArray(bodies.*BODY_FLOATS[k], bodyFloats[k], n);
+    }
+    copyArray(bodies.sleepGroup, sleepGroup, n);
+    copyArray(bodies.awake, awake, n);
+    copyArray(bodies.bullet, bullet, n);
+    bodies.type = types;
+    bodies.staticsChanged();   // rebuilds the world's static tree and body lists
+
+    // create() handed out fresh ids; put back the saved ones so old handles resolve.
+    bodies.indexToId = ids;
+    bodies.generations.resize(idCount);
+    copyArray(bodies.generations, generations, idCount);
+    bodies.freeIds = freeList;
+    bodies.idToIndex.assign(idCount, 0);
+    for (size_t i = 0; i < n; i++) {
+        bodies.idToIndex[ids[i]] = static_cast<std::uint32_t>(i);
+        bodies.poseChanged(i);
+    }
+
+    for (const ForceRecord& force : forces) {
+        ForceDef def;
+        def.type = static_cast<ForceType>(force.type);
+        def.vector = sf::Vector2f(force.x, force.y);
+        def.coefficient = force.coefficient;
+        def.damping = force.damping;
+        bodies.forces.add(force.body, def);
+    }
+
+    ContactSolver& solver = world.solver;
+    for (const PairRecord& pair : pairs) {
+        ContactSolver::CachedManifold manifold{};
+        manifold.generationA = pair.generationA;
+        manifold.generationB = pair.generationB;
+        manifold.pointCount = std::max(0, std::min(2, static_cast<int>(pair.pointCount)));
+        manifold.lastStep = pair.lastStep;
+        for (int k = 0; k < 2; k++) {
+            manifold.points[k] = {pair.points[k].feature, pair.points[k].normalImpulse, pair.points[k].tangentImpulse};
+        }
+        solver.pairs[{pair.idA, pair.idB, pair.wall}] = manifold;
+    }
+    solver.stepCount = solverStep;
+
+    LOG(LogCategory::WORLD, LogLevel::INFO) << "Snapshot restored: " << n << " bodies, " << m << " particles";
+    return true;
+}
@@ -0,0 +1,99 @@
+#include "StaticBVH.hpp"
+#include <algorithm>
+
+namespace {
+
+const std::uint32_t LEAF_SIZE = 4;
+
+AABB merge(const AABB& a, const AABB& b) {
+    AABB box;
+    box.min = sf::Vector2f(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y));
+    box.max = sf::Vector2f(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y));
+    return box;
+}
+
+}
+
+void StaticBVH::build(const BodyStore& bodies) {
+    clear();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (bodies.type[i] != BodyType::STATIC) continue;
+        const AABB& box = bodies.aabbs[i];
+        items.push_back({box, (box.min + box.max) * 0.5f, bodies.handleAt(i).id});
+    }
+    if (items.empty()) return;
+
+    nodes.reserve(2 * items.size() / LEAF_SIZE + 1);
+    buildRange(0, static_cast<std::uint32_t>(items.size()));
+
+    boxes.reserve(items.size());
+    ids.reserve(items.size());
+    for (const Item& item : items) {
+        boxes.push_back(item.box);
+        ids.push_back(item.id);
+    }
+    items.clear();
+}
+
+void StaticBVH::clear() {
+    nodes.clear();
+    boxes.clear();
+    ids.clear();
+    items.clear();
+}
+
+std::uint32_t StaticBVH::buildRange(std::uint32_t begin, std::uint32_t end) {
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(Node());
+
+    AABB box = items[begin].box;
+    sf::Vector2f low = items[begin].center, high = low;
+    for (std::uint32_t k = begin + 1; k < end; k++) {
+        box = merge(box, items[k].box);
+        low = sf::Vector2f(std::min(low.x, items[k].center.x), std::min(low.y, items[k].center.y));
+        high = sf::Vector2f(std::max(high.x, items[k].center.x), std::max(high.y, items[k].center.y));
+    }
+
+    if (end - begin <= LEAF_SIZE) {
+        nodes[index] = {box, begin, 0, end - begin};
+        return index;
+    }
+
+    // Halve at the median centre along the longer side. Ties go by id, so
+    // which items end up on each side doesn't depend on their input order.
+    bool alongX = high.x - low.x >= high.y - low.y;
+    std::uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+        [alongX](const Item& a, const Item& b) {
+            float keyA = alongX ? a.center.x : a.center.y;
+            float keyB = alongX ? b.center.x : b.center.y;
+            return keyA != keyB ? keyA < keyB : a.id < b.id;
+        });
+
+    std::uint32_t left = buildRange(begin, middle);
+    std::uint32_t right = buildRange(middle, end);
+    nodes[index] = {box, left, right, 0};
+    return index;
+}
+
+void StaticBVH::query(const AABB& box, std::vector<std::uint32_t>& result) const {
+    result.clear();
+    if (nodes.empty()) return;
+
+    // Median splits keep the depth near log2(size / LEAF_SIZE), far below this.
+    std::uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!node.box.overlaps(box)) continue;
+        if (node.count > 0) {
+            for (std::uint32_t k = node.first; k < node.first + node.count; k++) {
+                if (boxes[k].overlaps(box)) result.push_back(ids[k]);
+            }
+            continue;
+        }
+        stack[top++] = node.second;
+        stack[top++] = node.first;
+    }
+}
@@ -0,0 +1,98 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (size_t slot = 1; slot < threadCount; slot++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, slot);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+
+    if (size() == 1 || count <= grain) {
+        fn(0, count, 0);
+        return;
+    }
+
+    size_t taskCount = (count + grain - 1) / grain;
+    std::atomic<size_t> remaining(taskCount);
+
+    // Count the tasks before publishing them so a thief never sees pending
+    // underflow; do it under the lock so a worker about to sleep can't miss it.
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending += taskCount;
+    }
+
+    // Deal tasks round-robin so every thread starts with local work.
+    for (size_t t = 0; t < taskCount; t++) {
+        Task task{t * grain, std::min(count, (t + 1) * grain), &fn, &remaining};
+        Queue& q = *queues[t % size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(task);
+    }
+    wake.notify_all();
+
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(0)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool ThreadPool::runOne(size_t slot) {
+    Task task;
+    bool found = false;
+
+    {
+        Queue& own = *queues[slot];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    for (size_t k = 1; !found && k < size(); k++) {
+        Queue& victim = *queues[(slot + k) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    pending--;
+    (*task.fn)(task.begin, task.end, slot);
+    task.remaining->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t slot) {
+    while (true) {
+        if (runOne(slot)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || pending.load() > 0; });
+        if (stopping) return;
+    }
+}
@@ -1,7 +1,7 @@
 #include "Environment.hpp"
 
 int main() {
-    Environment env(800, 600, "2D Physics Engine");
+    Environment env(800, 600, "2D Physics Engine", sf::Vector2f(3200.0f, 1200.0f));
     env.run(); 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+// Deterministic-mode regression: a mixed scene of boxes, circles and
+// particles must produce the same step hash on every step whatever the
+// thread count, and a world restored from a snapshot taken mid-run must
+// carry on with the same hashes as the world it was taken from.
+//
+// Exits non-zero on failure.
+#include "PhysicsWorld.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int STEPS = 240;
+const int SPAWN_STEPS = 150;
+const int SNAPSHOT_STEP = 100;
+
+void setupScene(PhysicsWorld& world) {
+    world.setDeterministic(true);
+    world.setSeed(19);
+    for (int i = 0; i < 60; i++) {
+        float x = 80.0f + (i % 12) * 55.0f;
+        float y = 60.0f + (i / 12) * 60.0f;
+        if (i % 2 == 0) {
+            world.createCircle({x, y}, 12.0f, {0, 0}, sf::Color::Blue);
+        } else {
+            world.createPolygon({{x, y}, {x + 30, y}, {x + 30, y + 20}, {x, y + 20}}, {0, 0}, sf::Color::Red);
+        }
+    }
+}
+
+// Steps world from its current step up to step last, spawning liquid early
+// on so the RNG is exercised, and appends each step's hash.
+void run(PhysicsWorld& world, int last, std::vector<std::uint64_t>& hashes) {
+    while (world.getStepCount() < static_cast<std::uint64_t>(last)) {
+        if (world.getStepCount() < static_cast<std::uint64_t>(SPAWN_STEPS)) {
+            world.spawnLiquidObjects({400, 80}, 10);
+        }
+        world.step(world.getStepCount() % 2 ? 1.0f / 100.0f : 1.0f / 200.0f);
+        hashes.push_back(world.getStepHash());
+    }
+}
+
+// Step of the first hash in run that differs from reference, where run
+// starts at step first, or -1 if they match.
+int firstMismatch(const std::vector<std::uint64_t>& reference, const std::vector<std::uint64_t>& run, int first = 0) {
+    for (size_t i = 0; i < reference.size() - first; i++) {
+        if (i >= run.size() || run[i] != reference[first + i]) return first + static_cast<int>(i);
+    }
+    return -1;
+}
+
+}
+
+int main() {
+    int failures = 0;
+
+    std::vector<std::uint64_t> reference;
+    {
+        PhysicsWorld world(800, 600);
+        world.setThreadCount(1);
+        setupScene(world);
+        run(world, STEPS, reference);
+        std::cout << "1 thread: " << world.getParticles().size() << " particles, final hash " << std::hex
+                  << reference.back() << std::dec << "\n";
+    }
+
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    for (size_t count : {size_t(2), threads}) {
+        PhysicsWorld world(800, 600);
+        world.setThreadCount(count);
+        setupScene(world);
+        std::vector<std::uint64_t> hashes;
+        run(world, STEPS, hashes);
+        int mismatch = firstMismatch(reference, hashes);
+        if (mismatch >= 0) {
+            std::cout << count << " threads: hashes diverge at step " << mismatch << "\n";
+            failures++;
+        }
+    }
+
+    // Snapshot partway through and continue in a fresh world.
+    {
+        PhysicsWorld world(800, 600);
+        world.setThreadCount(threads);
+        setupScene(world);
+        std::vector<std::uint64_t> hashes;
+        run(world, SNAPSHOT_STEP, hashes);
+
+        Snapshot snapshot;
+        PhysicsWorld restored(800, 600);
+        restored.setThreadCount(1);
+        if (!snapshot.open(Snapshot::capture(world)) || !snapshot.restore(restored)) {
+            std::cout << "snapshot could not be restored\n";
+            failures++;
+        } else {
+            std::vector<std::uint64_t> continued;
+            run(restored, STEPS, continued);
+            int mismatch = firstMismatch(reference, continued, SNAPSHOT_STEP);
+            if (mismatch >= 0) {
+                std::cout << "restored world diverges at step " << mismatch << "\n";
+                failures++;
+            }
+        }
+    }
+
+    std::cout << (failures ? "FAIL" : "PASS") << "\n";
+    return failures;
+}